@@ -1,16 +1,29 @@
 #ifndef LEVEL_FILE_H
 #define LEVEL_FILE_H
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <filesystem>
 #include <fstream>
-#include <iostream>
-#include <istream>
-#include <stdlib.h>
-#include <iterator>
-#include <glm/glm.hpp>
-#include "rle.h"
+#include <cstdint>
+#include <cstring>
+#include "cgerikj_rle.h"
+
+#if defined _WIN32 || defined __CYGWIN__
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 /*
 * File structure:
@@ -19,18 +32,140 @@
 * The rest of the buffer contain the chunks. Indices in the table origate from byte 0 in the buffer.
 */
 
+struct ChunkTableEntry {
+  uint32_t key, rleDataBegin, rleDataSize;
+};
+
+// Read-only view of a whole file. Memory-mapped where the platform allows
+// it, so opening costs a few page faults instead of a copy; otherwise the
+// file is read into an owned buffer with large positional reads.
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() { close(); }
+
+  bool open(const std::string& path) {
+    close();
+#if defined _WIN32 || defined __CYGWIN__
+    std::wstring widePath = std::filesystem::u8path(path).wstring();
+    file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+      close();
+      return false;
+    }
+    length = (size_t)fileSize.QuadPart;
+    if (length > 0) {
+      mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping) {
+        view = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      }
+      if (!view && !readFallback()) {
+        close();
+        return false;
+      }
+    }
+#else
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close();
+      return false;
+    }
+    length = (size_t)st.st_size;
+    if (length > 0) {
+      void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        view = (const uint8_t*)p;
+        madvise(p, length, MADV_WILLNEED);
+      }
+      else if (!readFallback()) {
+        close();
+        return false;
+      }
+    }
+#endif
+    return true;
+  }
+
+  void close() {
 #if defined _WIN32 || defined __CYGWIN__
-#define PATH_SEP "\\"
+    if (view && fallback.empty()) UnmapViewOfFile(view);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
 #else
-#define PATH_SEP "/"
+    if (view && fallback.empty()) munmap((void*)view, length);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
 #endif
+    view = nullptr;
+    length = 0;
+    fallback.clear();
+    fallback.shrink_to_fit();
+  }
 
-struct ChunkTableEntry {
-  uint32_t key, rleDataBegin, rleDataSize;
+  const uint8_t* data() const { return view; }
+  size_t size() const { return length; }
+  bool isOpen() const { return view != nullptr; }
+  bool isMapped() const { return view != nullptr && fallback.empty(); }
+
+private:
+  bool readFallback() {
+    fallback.resize(length);
+    size_t done = 0;
+    while (done < length) {
+      const size_t block = std::min<size_t>(length - done, (size_t)1 << 24);
+#if defined _WIN32 || defined __CYGWIN__
+      OVERLAPPED at = {};
+      at.Offset = (DWORD)(done & 0xFFFFFFFFu);
+      at.OffsetHigh = (DWORD)((uint64_t)done >> 32);
+      DWORD got = 0;
+      if (!ReadFile(file, fallback.data() + done, (DWORD)block, &got, &at) || got == 0) {
+        return false;
+      }
+#else
+      const ssize_t got = pread(fd, fallback.data() + done, block, (off_t)done);
+      if (got <= 0) {
+        return false;
+      }
+#endif
+      done += (size_t)got;
+    }
+    view = fallback.data();
+    return true;
+  }
+
+  const uint8_t* view = nullptr;
+  size_t length = 0;
+  std::vector<uint8_t> fallback;
+#if defined _WIN32 || defined __CYGWIN__
+  HANDLE file = INVALID_HANDLE_VALUE;
+  HANDLE mapping = nullptr;
+#else
+  int fd = -1;
+#endif
+};
+
+// Zero-copy view of one chunk's RLE data inside a loaded level.
+struct ChunkSpan {
+  const uint8_t* data = nullptr;
+  uint32_t size = 0;
 };
 
 class LevelFile {
 public:
+  // Filled by compressAndAddChunk and written by saveToFile; loadFromFile
+  // replaces it with a copy of the loaded table.
   std::vector<ChunkTableEntry> chunkTable;
   std::vector<uint8_t> buffer;
 
@@ -43,37 +178,100 @@ public:
     buffer.assign(maxFileSize, 0);
   }
 
-  uint8_t getSize() {
+  uint8_t getSize() const {
     return size;
   }
 
-  void loadFromFile(std::string levelName) {
-    std::ifstream file(".." PATH_SEP "levels" PATH_SEP + levelName, std::ios::binary);
-    file.unsetf(std::ios::skipws);
+  // Map a level file. Chunk data is read in place from the mapping (see
+  // getChunkData) until the next load; the table is also copied into
+  // chunkTable, and a key -> entry hash index is built for findChunk.
+  bool loadFromFile(const std::string& path) {
+    file.close();
+    size = 0;
+    tableLength = 0;
+    chunkTable.clear();
+    keySlots.clear();
+    chunkCount = 0;
 
-    if (file.is_open()) {
-      std::streampos fileSize;
-      file.seekg(0, std::ios::end);
-      fileSize = file.tellg();
-      file.seekg(0, std::ios::beg);
+    if (!file.open(path) || file.size() < 1) {
+      file.close();
+      return false;
+    }
 
-      buffer.reserve(fileSize);
-      buffer.insert(buffer.begin(), std::istream_iterator<uint8_t>(file), std::istream_iterator<uint8_t>());
+    const uint8_t worldSize = file.data()[0];
+    const uint32_t length = worldSize * worldSize;
+    if (file.size() < 1 + (size_t)length * sizeof(ChunkTableEntry)) {
+      file.close();
+      return false;
+    }
 
-      int bufferHead = 0;
+    size = worldSize;
+    tableLength = length;
+    chunkTable.resize(length);
+    std::memcpy(chunkTable.data(), file.data() + 1, (size_t)length * sizeof(ChunkTableEntry));
+    buildKeyIndex();
+    return true;
+  }
 
-      size = buffer[0];
-      bufferHead++;
+  // Table index of the chunk stored under `key`, or -1. One hash probe
+  // sequence, independent of the world size.
+  int32_t findChunk(uint32_t key) const {
+    if (keySlots.empty()) {
+      return -1;
+    }
+    const size_t mask = keySlots.size() - 1;
+    for (size_t slot = hashKey(key) & mask;; slot = (slot + 1) & mask) {
+      const KeySlot& s = keySlots[slot];
+      if (s.index == EMPTY_SLOT) {
+        return -1;
+      }
+      if (s.key == key) {
+        return (int32_t)s.index;
+      }
+    }
+  }
 
-      uint32_t tableLength = size * size;
-      uint32_t tableSize =  tableLength * sizeof(ChunkTableEntry);
+  // RLE data of the chunk stored under `key`; empty if there is none.
+  ChunkSpan getChunkByKey(uint32_t key) const {
+    const int32_t i = findChunk(key);
+    return i < 0 ? ChunkSpan() : getChunkData((uint32_t)i);
+  }
 
-      chunkTable.resize(tableLength);
+  // Number of non-empty entries in the loaded table.
+  uint32_t getChunkCount() const {
+    return chunkCount;
+  }
 
-      std::memcpy(chunkTable.data(), &buffer[bufferHead], tableSize);
+  uint32_t getTableLength() const {
+    return tableLength;
+  }
 
-      file.close();
+  // Table entries are 12 bytes from byte 1, so they are copied out rather
+  // than referenced (they are not 4-byte aligned). Out-of-range indices give
+  // an empty entry.
+  ChunkTableEntry getTableEntry(uint32_t i) const {
+    ChunkTableEntry entry = {};
+    if (i >= tableLength) {
+      return entry;
+    }
+    std::memcpy(&entry, file.data() + 1 + (size_t)i * sizeof(ChunkTableEntry), sizeof(ChunkTableEntry));
+    return entry;
+  }
+
+  // RLE data of table entry i; empty for unused entries or ones that point
+  // outside the file.
+  ChunkSpan getChunkData(uint32_t i) const {
+    ChunkSpan span;
+    if (i >= tableLength) {
+      return span;
     }
+    const ChunkTableEntry entry = getTableEntry(i);
+    if (entry.rleDataSize == 0 || (uint64_t)entry.rleDataBegin + entry.rleDataSize > file.size()) {
+      return span;
+    }
+    span.data = file.data() + entry.rleDataBegin;
+    span.size = entry.rleDataSize;
+    return span;
   }
 
   void compressAndAddChunk(std::vector<uint8_t>& voxels, uint32_t key) {
@@ -90,25 +288,67 @@ public:
     dataBufferHead += rleVoxels.size();
   }
 
-  void saveToFile(std::string newLevelName) {
+  bool saveToFile(const std::string& path) {
     buffer[0] = size;
 
     memcpy(buffer.data() + 1, chunkTable.data(), chunkTable.size() * sizeof(ChunkTableEntry));
 
     buffer.resize(dataBufferHead + 1);
 
-    std::string saveDir = ".." PATH_SEP "levels" PATH_SEP;
-    std::filesystem::create_directory(saveDir);
+    const std::filesystem::path filePath(path);
+    if (filePath.has_parent_path()) {
+      std::error_code ec;
+      std::filesystem::create_directories(filePath.parent_path(), ec);
+    }
 
-    std::ofstream file;
-    file.open(saveDir + newLevelName, std::ios::out | std::ios::binary);
-    file.write((char*)buffer.data(), dataBufferHead);
-    file.close();
+    std::ofstream out(filePath, std::ios::out | std::ios::binary);
+    out.write((char*)buffer.data(), dataBufferHead);
+    return out.good();
   }
 
 private:
+  struct KeySlot {
+    uint32_t key, index;
+  };
+
+  static constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+
+  static size_t hashKey(uint32_t key) {
+    return (size_t)(((uint64_t)key * 0x9E3779B97F4A7C15ull) >> 32);
+  }
+
+  // Open addressing with linear probing at a load factor of at most 1/2.
+  // The first entry for a key wins, matching a front-to-back table scan.
+  void buildKeyIndex() {
+    size_t capacity = 16;
+    while (capacity < (size_t)tableLength * 2) {
+      capacity *= 2;
+    }
+    keySlots.assign(capacity, KeySlot({ 0, EMPTY_SLOT }));
+
+    const size_t mask = capacity - 1;
+    for (uint32_t i = 0; i < tableLength; i++) {
+      if (!getChunkData(i).data) {
+        continue;
+      }
+      const uint32_t key = getTableEntry(i).key;
+      size_t slot = hashKey(key) & mask;
+      while (keySlots[slot].index != EMPTY_SLOT && keySlots[slot].key != key) {
+        slot = (slot + 1) & mask;
+      }
+      if (keySlots[slot].index == EMPTY_SLOT) {
+        keySlots[slot] = KeySlot({ key, i });
+        chunkCount++;
+      }
+    }
+  }
+
   uint8_t size = 0;
   uint32_t dataBufferHead = 1;
+  MappedFile file;
+  uint32_t tableLength = 0;
+  uint32_t chunkCount = 0;
+  std::vector<KeySlot> keySlots;
 };
 
 #endif
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <cstring>
+#include <cstdint>
+#include <cmath>
 
 inline void addRleRun(std::vector<uint8_t>& rleVoxels, uint8_t type, uint32_t length) {
   uint8_t subLength = 0;
@@ -23,7 +25,7 @@ inline void addRleRun(std::vector<uint8_t>& rleVoxels, uint8_t type, uint32_t le
 }
 
 namespace rle {
-  void compress(std::vector<uint8_t> &voxels, std::vector<uint8_t> &rleVoxels) {
+  inline void compress(std::vector<uint8_t> &voxels, std::vector<uint8_t> &rleVoxels) {
     uint8_t type = 0;
     uint32_t length = 0;
 
@@ -42,11 +44,12 @@ namespace rle {
     addRleRun(rleVoxels, (uint8_t)type, length);
   }
 
-  inline const uint64_t getBitRange(uint8_t low, uint8_t high) {
+  // Local fix: dropped a meaningless const on the return type (-Wignored-qualifiers).
+  inline uint64_t getBitRange(uint8_t low, uint8_t high) {
     return  ((1ULL << (high - low + 1)) - 1) << low;
   }
 
-  void decompressToVoxelsAndOpaqueMask(uint8_t* rleVoxels, int rleSize, uint8_t* voxels, uint64_t* opaqueMask) {
+  inline void decompressToVoxelsAndOpaqueMask(uint8_t* rleVoxels, int rleSize, uint8_t* voxels, uint64_t* opaqueMask) {
     uint8_t* p = rleVoxels;
     uint8_t* p_end = rleVoxels + rleSize;
     uint8_t* u_p = voxels;
@@ -76,7 +79,8 @@ namespace rle {
         else if (remainingLength >= 64 && opaqueMaskBitIndex == 0) {
           int count = std::floor(remainingLength / 64);
           if (type) {
-            memset(&opaqueMask[opaqueMaskIndex], (uint64_t)-1, count * sizeof(uint64_t));
+            // Local fix: memset takes a byte; (uint64_t)-1 overflowed to 0xFF anyway (-Woverflow).
+            memset(&opaqueMask[opaqueMaskIndex], 0xFF, count * sizeof(uint64_t));
           }
           opaqueMaskIndex += count;
           remainingLength -= count * 64;
@@ -3,7 +3,19 @@
 #include <godot_cpp/godot.hpp>
 #include <godot_cpp/core/class_db.hpp>
 
+#include "voxel_chunk.h"
+#include "voxel_chunk_codec.h"
+#include "voxel_compressed_chunk.h"
+#include "voxel_edit.h"
 #include "voxel_greedy_mesher.h"
+#include "voxel_level_file.h"
+#include "voxel_prefab.h"
+#include "voxel_region_file.h"
+#include "voxel_save_job.h"
+#include "voxel_storage.h"
+#include "voxel_surface_nets_mesher.h"
+#include "voxel_terrain_generator.h"
+#include "voxel_world.h"
 
 using namespace godot;
 
@@ -12,7 +24,19 @@ void initialize_voxel_greedy_mesher_module(ModuleInitializationLevel p_level) {
         return;
     }
 
+    ClassDB::register_class<VoxelChunk>();
+    ClassDB::register_class<VoxelChunkCodec>();
+    ClassDB::register_class<VoxelCompressedChunk>();
     ClassDB::register_class<VoxelGreedyMesher>();
+    ClassDB::register_class<VoxelWorld>();
+    ClassDB::register_class<VoxelEdit>();
+    ClassDB::register_class<VoxelPrefab>();
+    ClassDB::register_class<VoxelLevelFile>();
+    ClassDB::register_class<VoxelRegionFile>();
+    ClassDB::register_class<VoxelStorage>();
+    ClassDB::register_class<VoxelSaveJob>();
+    ClassDB::register_class<VoxelTerrainGenerator>();
+    ClassDB::register_class<VoxelSurfaceNetsMesher>();
 }
 
 void uninitialize_voxel_greedy_mesher_module(ModuleInitializationLevel p_level) {
@@ -0,0 +1,41 @@
+// voxel_bits.h
+#pragma once
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// Bit scan helpers for 64-bit column masks. Callers must not pass 0.
+namespace voxel_bits {
+
+static inline int ctz64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return (int)i;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+static inline int clz64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanReverse64(&i, v);
+    return 63 - (int)i;
+#else
+    return __builtin_clzll(v);
+#endif
+}
+
+static inline int popcount64(uint64_t v) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(v);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+} // namespace voxel_bits
@@ -0,0 +1,232 @@
+// voxel_chunk.cpp
+
+#include "voxel_chunk.h"
+#include "voxel_rle.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <string.h>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Layout helpers
+// -----------------------------------------------------------------------------
+
+static constexpr int N = VoxelChunk::SIZE;
+
+// Per-thread scratch for XYZ <-> ZXY conversions and RLE coding.
+static thread_local uint8_t g_chunk_scratch_zxy[VoxelChunk::VOXEL_COUNT];
+static thread_local uint8_t g_chunk_scratch_rle[voxel_rle::max_encoded_chunk_size()];
+
+// Caller layout XYZ: idx = x + y*64 + z*64*64
+static inline int index_xyz(int x, int y, int z) {
+    return x + y * N + z * N * N;
+}
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelChunk::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("get_voxel", "x", "y", "z"), &VoxelChunk::get_voxel);
+    ClassDB::bind_method(D_METHOD("set_voxel", "x", "y", "z", "material"), &VoxelChunk::set_voxel);
+    ClassDB::bind_method(D_METHOD("get_voxel_flags", "x", "y", "z"), &VoxelChunk::get_voxel_flags);
+    ClassDB::bind_method(D_METHOD("set_voxel_flags", "x", "y", "z", "flags"), &VoxelChunk::set_voxel_flags);
+
+    ClassDB::bind_method(D_METHOD("fill", "material"), &VoxelChunk::fill);
+    ClassDB::bind_method(D_METHOD("fill_box", "from", "to", "material"), &VoxelChunk::fill_box);
+    ClassDB::bind_method(D_METHOD("set_materials", "material64_xyz"), &VoxelChunk::set_materials);
+    ClassDB::bind_method(D_METHOD("get_materials"), &VoxelChunk::get_materials);
+
+    ClassDB::bind_method(D_METHOD("encode_rle"), &VoxelChunk::encode_rle);
+    ClassDB::bind_method(D_METHOD("decode_rle", "rle"), &VoxelChunk::decode_rle);
+
+    ClassDB::bind_method(D_METHOD("is_uniform"), &VoxelChunk::is_uniform);
+    ClassDB::bind_method(D_METHOD("get_memory_usage"), &VoxelChunk::get_memory_usage);
+    ClassDB::bind_method(D_METHOD("snapshot"), &VoxelChunk::snapshot);
+}
+
+// -----------------------------------------------------------------------------
+// Single voxel access
+// -----------------------------------------------------------------------------
+
+int VoxelChunk::get_voxel(int x, int y, int z) const {
+    if (!in_bounds(x, y, z)) {
+        return 0;
+    }
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return materials.get(x, y, z);
+}
+
+void VoxelChunk::set_voxel(int x, int y, int z, int material) {
+    if (!in_bounds(x, y, z)) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> guard(lock);
+    materials.set(x, y, z, (uint8_t)material);
+}
+
+int VoxelChunk::get_voxel_flags(int x, int y, int z) const {
+    if (!in_bounds(x, y, z)) {
+        return 0;
+    }
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return flags.get(x, y, z);
+}
+
+void VoxelChunk::set_voxel_flags(int x, int y, int z, int value) {
+    if (!in_bounds(x, y, z)) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> guard(lock);
+    flags.set(x, y, z, (uint8_t)value);
+}
+
+// -----------------------------------------------------------------------------
+// Bulk access
+// -----------------------------------------------------------------------------
+
+void VoxelChunk::fill(int material) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    materials.fill((uint8_t)material);
+    flags.fill(0);
+}
+
+void VoxelChunk::fill_box(const Vector3i &from, const Vector3i &to, int material) {
+    const int x0 = std::max(from.x, 0), x1 = std::min(to.x, N);
+    const int y0 = std::max(from.y, 0), y1 = std::min(to.y, N);
+    const int z0 = std::max(from.z, 0), z1 = std::min(to.z, N);
+    if (x0 >= x1 || y0 >= y1 || z0 >= z1) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+
+    // z is the fastest axis in storage: every (x, y) row is one contiguous run.
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            materials.fill_run(VoxelPaletteStorage::index_zxy(x, y, z0), z1 - z0, (uint8_t)material);
+        }
+    }
+}
+
+void VoxelChunk::set_materials(const PackedByteArray &material64_xyz) {
+    if (material64_xyz.size() != VOXEL_COUNT) {
+        return;
+    }
+
+    const uint8_t *src = material64_xyz.ptr();
+    uint8_t       *dst = g_chunk_scratch_zxy;
+
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            for (int z = 0; z < N; ++z) {
+                *dst++ = src[index_xyz(x, y, z)];
+            }
+        }
+    }
+
+    pack_materials_zxy(g_chunk_scratch_zxy);
+}
+
+PackedByteArray VoxelChunk::get_materials() const {
+    PackedByteArray out;
+    out.resize(VOXEL_COUNT);
+
+    unpack_materials_zxy(g_chunk_scratch_zxy);
+
+    const uint8_t *src = g_chunk_scratch_zxy;
+    uint8_t       *dst = out.ptrw();
+
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            for (int z = 0; z < N; ++z) {
+                dst[index_xyz(x, y, z)] = *src++;
+            }
+        }
+    }
+
+    return out;
+}
+
+PackedByteArray VoxelChunk::encode_rle() const {
+    unpack_materials_zxy(g_chunk_scratch_zxy);
+    const size_t size = voxel_rle::encode_chunk(g_chunk_scratch_zxy, g_chunk_scratch_rle);
+
+    PackedByteArray out;
+    out.resize(size);
+    memcpy(out.ptrw(), g_chunk_scratch_rle, size);
+    return out;
+}
+
+bool VoxelChunk::decode_rle(const PackedByteArray &rle) {
+    return decode_rle_data(rle.ptr(), rle.size());
+}
+
+bool VoxelChunk::is_uniform() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return materials.is_uniform();
+}
+
+int64_t VoxelChunk::get_memory_usage() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return (int64_t)(materials.get_memory_usage() + flags.get_memory_usage());
+}
+
+Ref<VoxelChunk> VoxelChunk::snapshot() const {
+    Ref<VoxelChunk> copy;
+    copy.instantiate();
+
+    std::shared_lock<std::shared_mutex> guard(lock);
+    copy->materials = materials;
+    copy->flags     = flags;
+    return copy;
+}
+
+// -----------------------------------------------------------------------------
+// Native access
+// -----------------------------------------------------------------------------
+
+void VoxelChunk::unpack_materials_zxy(uint8_t *dst_zxy) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    materials.unpack_zxy(dst_zxy);
+}
+
+void VoxelChunk::pack_materials_zxy(const uint8_t *src_zxy) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    materials.pack_zxy(src_zxy);
+}
+
+bool VoxelChunk::unpack_flags_zxy(uint8_t *dst_zxy) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    if (flags.is_uniform() && flags.get_at(0) == 0) {
+        return false;
+    }
+    flags.unpack_zxy(dst_zxy);
+    if (flags.is_uniform()) {
+        return true;
+    }
+    // The palette may still hold flags no voxel uses any more.
+    for (int i = 0; i < VOXEL_COUNT; ++i) {
+        if (dst_zxy[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void VoxelChunk::pack_flags_zxy(const uint8_t *src_zxy) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    flags.pack_zxy(src_zxy);
+}
+
+bool VoxelChunk::decode_rle_data(const uint8_t *data, size_t size) {
+    if (!voxel_rle::decode(data, size, g_chunk_scratch_zxy, VOXEL_COUNT)) {
+        return false;
+    }
+    pack_materials_zxy(g_chunk_scratch_zxy);
+    return true;
+}
@@ -0,0 +1,119 @@
+// voxel_chunk.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "voxel_palette_storage.h"
+
+using namespace godot;
+
+/// Native owner of one padded 64^3 chunk of voxel data.
+///
+/// Materials and per-voxel flags live in palette-compressed storage off the
+/// script heap, so scripts hold a reference instead of a 256 KB byte array
+/// and the mesher reads the data in place (VoxelGreedyMesher::mesh_chunk).
+///
+/// Coordinates are local 0..63 and include the 1-voxel padding shared with
+/// neighbouring chunks. Reads take a shared lock and writes an exclusive
+/// one, so worker threads may mesh a chunk while others read it.
+class VoxelChunk : public RefCounted {
+    GDCLASS(VoxelChunk, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    static constexpr int SIZE        = VoxelPaletteStorage::SIZE;         // 64
+    static constexpr int VOXEL_COUNT = VoxelPaletteStorage::VOXEL_COUNT;  // 64^3
+
+    VoxelChunk() = default;
+    ~VoxelChunk() = default;
+
+    // --- Single voxel access (bounds-checked, out of range reads return 0) ---
+
+    int get_voxel(int x, int y, int z) const;
+    void set_voxel(int x, int y, int z, int material);
+
+    int get_voxel_flags(int x, int y, int z) const;
+    void set_voxel_flags(int x, int y, int z, int value);
+
+    // --- Bulk access ---
+
+    /// Set every voxel to `material` and clear all flags.
+    void fill(int material);
+
+    /// Set all voxels in [from, to) to `material`. The box is clipped to the chunk.
+    void fill_box(const Vector3i &from, const Vector3i &to, int material);
+
+    /// Replace all materials from a PackedByteArray of 64^3 bytes in the
+    /// mesher's caller layout (idx = x + y*64 + z*64*64). Flags are kept.
+    void set_materials(const PackedByteArray &material64_xyz);
+
+    /// Materials as a 64^3 PackedByteArray in XYZ layout (idx = x + y*64 + z*64*64).
+    PackedByteArray get_materials() const;
+
+    bool is_uniform() const;
+
+    /// Materials run-length encoded (voxel_rle.h format v3) in whichever
+    /// scan order compresses this chunk best; the form chunks are saved in.
+    PackedByteArray encode_rle() const;
+
+    /// Replace materials from encode_rle() output of any format version
+    /// (v1 streams from cgerikj_rle.h included). Flags are kept. Returns
+    /// false, leaving the chunk unchanged, if the stream is not a whole chunk.
+    bool decode_rle(const PackedByteArray &rle);
+
+    /// Resident bytes of material and flag storage.
+    int64_t get_memory_usage() const;
+
+    /// A copy of this chunk as it is now. The voxel data is shared
+    /// copy-on-write (VoxelPaletteStorage), so this is cheap, and the first
+    /// later write to either chunk pays for the copy. Used to save chunks
+    /// on worker threads while the live chunk keeps being edited.
+    Ref<VoxelChunk> snapshot() const;
+
+    // --- Native access (not bound) ---
+
+    /// Decode materials into a 64^3 ZXY buffer (the mesher's native layout).
+    void unpack_materials_zxy(uint8_t *dst_zxy) const;
+
+    /// Replace materials from a 64^3 ZXY buffer. Flags are kept.
+    void pack_materials_zxy(const uint8_t *src_zxy);
+
+    /// Decode flags into a 64^3 ZXY buffer. Returns false if every flag is
+    /// 0; `dst_zxy` is then left untouched when the flags are uniform.
+    bool unpack_flags_zxy(uint8_t *dst_zxy) const;
+
+    /// Replace flags from a 64^3 ZXY buffer. Materials are kept.
+    void pack_flags_zxy(const uint8_t *src_zxy);
+
+    /// decode_rle() from raw bytes (e.g. a span of a mapped level file).
+    bool decode_rle_data(const uint8_t *data, size_t size);
+
+    /// Read-modify-write under one exclusive lock: decode into `scratch_zxy`,
+    /// call `fn(scratch_zxy)` and re-pack if it returns true.
+    template <typename F>
+    bool edit_materials_zxy(uint8_t *scratch_zxy, F &&fn) {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        materials.unpack_zxy(scratch_zxy);
+        if (!fn(scratch_zxy)) {
+            return false;
+        }
+        materials.pack_zxy(scratch_zxy);
+        return true;
+    }
+
+private:
+    mutable std::shared_mutex lock;
+    VoxelPaletteStorage       materials;
+    VoxelPaletteStorage       flags;
+
+    static inline bool in_bounds(int x, int y, int z) {
+        return (unsigned)x < (unsigned)SIZE && (unsigned)y < (unsigned)SIZE && (unsigned)z < (unsigned)SIZE;
+    }
+};
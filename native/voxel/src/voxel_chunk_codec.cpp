@@ -0,0 +1,102 @@
+// voxel_chunk_codec.cpp
+
+#include "voxel_chunk_codec.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+#include <string.h>
+#include <vector>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+static thread_local uint8_t              g_codec_scratch_zxy[VoxelChunk::VOXEL_COUNT];
+static thread_local std::vector<uint8_t> g_codec_payload;
+
+static PackedByteArray to_packed(const std::vector<uint8_t> &bytes) {
+    PackedByteArray out;
+    out.resize((int64_t)bytes.size());
+    memcpy(out.ptrw(), bytes.data(), bytes.size());
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelChunkCodec::_bind_methods() {
+    ClassDB::bind_static_method("VoxelChunkCodec", D_METHOD("encode", "chunk", "codec"), &VoxelChunkCodec::encode);
+    ClassDB::bind_static_method("VoxelChunkCodec", D_METHOD("encode_with_policy", "chunk", "policy"), &VoxelChunkCodec::encode_with_policy);
+    ClassDB::bind_static_method("VoxelChunkCodec", D_METHOD("decode", "data"), &VoxelChunkCodec::decode);
+    ClassDB::bind_static_method("VoxelChunkCodec", D_METHOD("get_codec", "data"), &VoxelChunkCodec::get_codec);
+    ClassDB::bind_static_method("VoxelChunkCodec", D_METHOD("get_codec_name", "codec"), &VoxelChunkCodec::get_codec_name);
+
+    BIND_ENUM_CONSTANT(CODEC_RAW);
+    BIND_ENUM_CONSTANT(CODEC_RLE);
+    BIND_ENUM_CONSTANT(CODEC_RLE_FASTLZ);
+    BIND_ENUM_CONSTANT(CODEC_RLE_DEFLATE);
+    BIND_ENUM_CONSTANT(CODEC_RLE_ZSTD);
+    BIND_ENUM_CONSTANT(CODEC_PALETTE_RANS);
+    BIND_ENUM_CONSTANT(CODEC_GENERATOR_DIFF);
+    BIND_ENUM_CONSTANT(CODEC_COUNT);
+
+    BIND_ENUM_CONSTANT(POLICY_FASTEST);
+    BIND_ENUM_CONSTANT(POLICY_BALANCED);
+    BIND_ENUM_CONSTANT(POLICY_SMALLEST);
+}
+
+// -----------------------------------------------------------------------------
+// Encoding & decoding
+// -----------------------------------------------------------------------------
+
+PackedByteArray VoxelChunkCodec::encode(const Ref<VoxelChunk> &chunk, Codec codec) {
+    ERR_FAIL_COND_V_MSG(chunk.is_null(), PackedByteArray(), "encode() needs a chunk.");
+    ERR_FAIL_INDEX_V_MSG((int)codec, (int)CODEC_COUNT, PackedByteArray(), "Unknown chunk codec.");
+    ERR_FAIL_COND_V_MSG(codec == CODEC_GENERATOR_DIFF, PackedByteArray(), "Generator diffs are written by VoxelStorage.");
+
+    chunk->unpack_materials_zxy(g_codec_scratch_zxy);
+    if (!voxel_codec::encode(g_codec_scratch_zxy, (voxel_codec::Codec)codec, g_codec_payload)) {
+        return PackedByteArray();
+    }
+    return to_packed(g_codec_payload);
+}
+
+PackedByteArray VoxelChunkCodec::encode_with_policy(const Ref<VoxelChunk> &chunk, Policy policy) {
+    ERR_FAIL_COND_V_MSG(chunk.is_null(), PackedByteArray(), "encode_with_policy() needs a chunk.");
+    ERR_FAIL_COND_V_MSG(policy < POLICY_FASTEST || policy > POLICY_SMALLEST, PackedByteArray(), "Unknown codec policy.");
+
+    chunk->unpack_materials_zxy(g_codec_scratch_zxy);
+    voxel_codec::encode_auto(g_codec_scratch_zxy, (voxel_codec::Policy)policy, g_codec_payload);
+    return to_packed(g_codec_payload);
+}
+
+Ref<VoxelChunk> VoxelChunkCodec::decode(const PackedByteArray &data) {
+    if (!voxel_codec::decode(data.ptr(), (size_t)data.size(), g_codec_scratch_zxy)) {
+        return Ref<VoxelChunk>();
+    }
+    Ref<VoxelChunk> chunk;
+    chunk.instantiate();
+    chunk->pack_materials_zxy(g_codec_scratch_zxy);
+    if (voxel_codec::has_flags(data.ptr(), (size_t)data.size())) {
+        if (!voxel_codec::decode_flags(data.ptr(), (size_t)data.size(), g_codec_scratch_zxy)) {
+            return Ref<VoxelChunk>();
+        }
+        chunk->pack_flags_zxy(g_codec_scratch_zxy);
+    }
+    return chunk;
+}
+
+int VoxelChunkCodec::get_codec(const PackedByteArray &data) {
+    const voxel_codec::Codec codec = voxel_codec::get_codec(data.ptr(), (size_t)data.size());
+    if (codec == voxel_codec::CODEC_LEGACY_RLE) {
+        return CODEC_RLE;
+    }
+    return codec < voxel_codec::CODEC_COUNT ? (int)codec : -1;
+}
+
+String VoxelChunkCodec::get_codec_name(Codec codec) {
+    return String(voxel_codec::get_codec_name((voxel_codec::Codec)codec));
+}
@@ -0,0 +1,65 @@
+// voxel_chunk_codec.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include "voxel_chunk.h"
+#include "voxel_codec.h"
+
+using namespace godot;
+
+/// The per-chunk save codecs (voxel_codec.h) from scripts: encode a chunk
+/// with a given codec or policy, decode any payload, and inspect which
+/// codec a payload uses. VoxelStorage writes chunks the same way; this is
+/// what benchmarks and tools use to compare codecs on real chunks.
+class VoxelChunkCodec : public RefCounted {
+    GDCLASS(VoxelChunkCodec, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    enum Codec {
+        CODEC_RAW            = voxel_codec::CODEC_RAW,
+        CODEC_RLE            = voxel_codec::CODEC_RLE,
+        CODEC_RLE_FASTLZ     = voxel_codec::CODEC_RLE_FASTLZ,
+        CODEC_RLE_DEFLATE    = voxel_codec::CODEC_RLE_DEFLATE,
+        CODEC_RLE_ZSTD       = voxel_codec::CODEC_RLE_ZSTD,
+        CODEC_PALETTE_RANS   = voxel_codec::CODEC_PALETTE_RANS,
+        CODEC_GENERATOR_DIFF = voxel_codec::CODEC_GENERATOR_DIFF,
+        CODEC_COUNT          = voxel_codec::CODEC_COUNT,
+    };
+
+    enum Policy {
+        POLICY_FASTEST  = voxel_codec::POLICY_FASTEST,
+        POLICY_BALANCED = voxel_codec::POLICY_BALANCED,
+        POLICY_SMALLEST = voxel_codec::POLICY_SMALLEST,
+    };
+
+    VoxelChunkCodec() = default;
+    ~VoxelChunkCodec() = default;
+
+    /// Materials of `chunk` as a payload of `codec`; empty on failure.
+    /// CODEC_GENERATOR_DIFF payloads are only written by VoxelStorage,
+    /// which has the generator to diff against.
+    static PackedByteArray encode(const Ref<VoxelChunk> &chunk, Codec codec);
+
+    /// Materials of `chunk` in whichever codec `policy` picks.
+    static PackedByteArray encode_with_policy(const Ref<VoxelChunk> &chunk, Policy policy);
+
+    /// A new chunk from a payload of any codec, with the flags of a flags
+    /// record; null if it is malformed or a generator diff (load those
+    /// through VoxelStorage).
+    static Ref<VoxelChunk> decode(const PackedByteArray &data);
+
+    /// Codec of a payload, or -1 if it is empty or unknown. Untagged RLE
+    /// payloads from older saves report CODEC_RLE.
+    static int get_codec(const PackedByteArray &data);
+
+    static String get_codec_name(Codec codec);
+};
+
+VARIANT_ENUM_CAST(VoxelChunkCodec::Codec);
+VARIANT_ENUM_CAST(VoxelChunkCodec::Policy);
@@ -0,0 +1,487 @@
+// voxel_codec.cpp
+
+#include "voxel_codec.h"
+#include "voxel_rle.h"
+
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+#include <string.h>
+
+using namespace godot;
+
+namespace voxel_codec {
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+static constexpr size_t RAW_SIZE        = 1 + CHUNK_VOLUME;
+static constexpr size_t PACKED_RLE_HEAD = 1 + 4;   // codec id, RLE stream size
+static constexpr size_t DIFF_HEAD       = 1 + 4;   // codec id, base key
+static constexpr size_t FLAGS_HEAD      = 1 + 4;   // FLAGS_RECORD, material payload size
+
+// rANS: 32-bit state kept in [RANS_L, RANS_L << 8), renormalized a byte at a time.
+static constexpr uint32_t RANS_PROB_BITS  = 12;
+static constexpr uint32_t RANS_PROB_SCALE = 1u << RANS_PROB_BITS;
+static constexpr uint32_t RANS_L          = 1u << 23;
+
+// Each voxel costs at most RANS_PROB_BITS bits, so two bytes, plus the final state.
+static constexpr size_t RANS_MAX_STREAM = size_t(CHUNK_VOLUME) * 2 + 4;
+
+struct DecodeSlot {
+    uint16_t freq;
+    uint16_t bias;       // slot - start of the symbol owning the slot
+    uint8_t  material;
+};
+
+static thread_local uint8_t              g_codec_rle[voxel_rle::max_encoded_chunk_size()];
+static thread_local uint8_t              g_codec_rans[RANS_MAX_STREAM];
+static thread_local DecodeSlot           g_codec_slots[RANS_PROB_SCALE];
+static thread_local std::vector<uint8_t> g_codec_candidate;
+static thread_local uint8_t              g_codec_diff[CHUNK_VOLUME];
+static thread_local std::vector<uint8_t> g_codec_inner;
+
+static inline void write_u16(uint8_t *p, uint16_t v) {
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+}
+
+static inline void write_u32(uint8_t *p, uint32_t v) {
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+    p[2] = uint8_t(v >> 16);
+    p[3] = uint8_t(v >> 24);
+}
+
+static inline uint16_t read_u16(const uint8_t *p) {
+    return uint16_t(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read_u32(const uint8_t *p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// The material payload of a flags record, or `src` itself for any other
+// payload. A record whose sizes do not add up, or that nests another
+// record, yields an empty payload.
+static inline const uint8_t *material_section(const uint8_t *src, size_t &size) {
+    if (size == 0 || src[0] != FLAGS_RECORD) {
+        return src;
+    }
+    if (size < FLAGS_HEAD || read_u32(src + 1) > size - FLAGS_HEAD) {
+        size = 0;
+        return src;
+    }
+    size = read_u32(src + 1);
+    if (size > 0 && src[FLAGS_HEAD] == FLAGS_RECORD) {
+        size = 0;
+    }
+    return src + FLAGS_HEAD;
+}
+
+static inline bool is_packed_rle(Codec codec) {
+    return codec == CODEC_RLE_FASTLZ || codec == CODEC_RLE_DEFLATE || codec == CODEC_RLE_ZSTD;
+}
+
+static inline void xor_chunk(const uint8_t *a, const uint8_t *b, uint8_t *dst) {
+    for (int i = 0; i < CHUNK_VOLUME; ++i) {
+        dst[i] = a[i] ^ b[i];
+    }
+}
+
+static inline int compression_mode(Codec codec) {
+    switch (codec) {
+        case CODEC_RLE_FASTLZ:  return FileAccess::COMPRESSION_FASTLZ;
+        case CODEC_RLE_DEFLATE: return FileAccess::COMPRESSION_DEFLATE;
+        default:                return FileAccess::COMPRESSION_ZSTD;
+    }
+}
+
+// RLE stream of the chunk into g_codec_rle; returns its size.
+static inline size_t encode_rle_stream(const uint8_t *src_zxy) {
+    return voxel_rle::encode_chunk(src_zxy, g_codec_rle);
+}
+
+static bool pack_rle(const uint8_t *rle, size_t rle_size, Codec codec, std::vector<uint8_t> &out) {
+    PackedByteArray input;
+    input.resize((int64_t)rle_size);
+    memcpy(input.ptrw(), rle, rle_size);
+
+    const PackedByteArray packed = input.compress(compression_mode(codec));
+    if (packed.is_empty()) {
+        return false;
+    }
+
+    out.resize(PACKED_RLE_HEAD + (size_t)packed.size());
+    out[0] = codec;
+    write_u32(out.data() + 1, (uint32_t)rle_size);
+    memcpy(out.data() + PACKED_RLE_HEAD, packed.ptr(), (size_t)packed.size());
+    return true;
+}
+
+static bool unpack_rle(const uint8_t *src, size_t size, Codec codec, uint8_t *dst_zxy) {
+    if (size < PACKED_RLE_HEAD) {
+        return false;
+    }
+    const uint32_t rle_size = read_u32(src + 1);
+    if (rle_size == 0 || rle_size > voxel_rle::max_encoded_chunk_size()) {
+        return false;
+    }
+
+    PackedByteArray input;
+    input.resize((int64_t)(size - PACKED_RLE_HEAD));
+    memcpy(input.ptrw(), src + PACKED_RLE_HEAD, size - PACKED_RLE_HEAD);
+
+    const PackedByteArray rle = input.decompress(rle_size, compression_mode(codec));
+    if ((uint32_t)rle.size() != rle_size) {
+        return false;
+    }
+    return voxel_rle::decode(rle.ptr(), rle_size, dst_zxy, CHUNK_VOLUME);
+}
+
+// Scale `counts` (summing to `total`) to frequencies summing to
+// RANS_PROB_SCALE, keeping every present symbol at 1 or more.
+static void normalize_frequencies(const uint32_t *counts, int n, uint32_t total, uint16_t *freq) {
+    uint32_t sum = 0;
+    int largest = 0;
+    for (int i = 0; i < n; ++i) {
+        uint32_t f = uint32_t(uint64_t(counts[i]) * RANS_PROB_SCALE / total);
+        f = f == 0 ? 1 : f;
+        freq[i] = (uint16_t)f;
+        sum += f;
+        largest = counts[i] > counts[largest] ? i : largest;
+    }
+
+    if (sum < RANS_PROB_SCALE) {
+        freq[largest] = uint16_t(freq[largest] + (RANS_PROB_SCALE - sum));
+        return;
+    }
+    // Rounding rare symbols up overshot; take it back from the most common ones.
+    while (sum > RANS_PROB_SCALE) {
+        int big = 0;
+        for (int i = 1; i < n; ++i) {
+            big = freq[i] > freq[big] ? i : big;
+        }
+        --freq[big];
+        --sum;
+    }
+}
+
+static void encode_palette_rans(const uint8_t *src_zxy, std::vector<uint8_t> &out) {
+    uint32_t counts[256] = {};
+    for (int i = 0; i < CHUNK_VOLUME; ++i) {
+        ++counts[src_zxy[i]];
+    }
+
+    uint8_t  palette[256];
+    uint8_t  lookup[256];
+    uint32_t palette_counts[256];
+    int n = 0;
+    for (int m = 0; m < 256; ++m) {
+        if (counts[m] != 0) {
+            lookup[m]         = (uint8_t)n;
+            palette[n]        = (uint8_t)m;
+            palette_counts[n] = counts[m];
+            ++n;
+        }
+    }
+
+    if (n == 1) {
+        out.resize(3);
+        out[0] = CODEC_PALETTE_RANS;
+        out[1] = 0;
+        out[2] = palette[0];
+        return;
+    }
+
+    uint16_t freq[256];
+    uint16_t start[256];
+    normalize_frequencies(palette_counts, n, CHUNK_VOLUME, freq);
+    uint32_t cumulative = 0;
+    for (int i = 0; i < n; ++i) {
+        start[i]    = (uint16_t)cumulative;
+        cumulative += freq[i];
+    }
+
+    // Encode backwards so the decoder reads the stream forwards.
+    uint8_t *const end = g_codec_rans + RANS_MAX_STREAM;
+    uint8_t *p = end;
+    uint32_t x = RANS_L;
+    for (int i = CHUNK_VOLUME - 1; i >= 0; --i) {
+        const int      s     = lookup[src_zxy[i]];
+        const uint32_t f     = freq[s];
+        const uint32_t x_max = ((RANS_L >> RANS_PROB_BITS) << 8) * f;
+        while (x >= x_max) {
+            *--p = uint8_t(x);
+            x >>= 8;
+        }
+        x = ((x / f) << RANS_PROB_BITS) + (x % f) + start[s];
+    }
+    p -= 4;
+    write_u32(p, x);
+
+    const size_t stream_size = size_t(end - p);
+    const size_t head_size   = 2 + size_t(n) * 3;
+    out.resize(head_size + stream_size);
+    out[0] = CODEC_PALETTE_RANS;
+    out[1] = uint8_t(n - 1);
+    memcpy(out.data() + 2, palette, n);
+    for (int i = 0; i < n; ++i) {
+        write_u16(out.data() + 2 + n + i * 2, freq[i]);
+    }
+    memcpy(out.data() + head_size, p, stream_size);
+}
+
+static bool decode_palette_rans(const uint8_t *src, size_t size, uint8_t *dst_zxy) {
+    if (size < 3) {
+        return false;
+    }
+    const int n = int(src[1]) + 1;
+    const uint8_t *palette = src + 2;
+    if (n == 1) {
+        if (size != 3) {
+            return false;
+        }
+        memset(dst_zxy, palette[0], CHUNK_VOLUME);
+        return true;
+    }
+
+    const size_t head_size = 2 + size_t(n) * 3;
+    if (size < head_size + 4) {
+        return false;
+    }
+
+    uint32_t cumulative = 0;
+    for (int i = 0; i < n; ++i) {
+        const uint32_t f = read_u16(src + 2 + n + i * 2);
+        if (f == 0 || cumulative + f > RANS_PROB_SCALE) {
+            return false;
+        }
+        for (uint32_t k = 0; k < f; ++k) {
+            g_codec_slots[cumulative + k] = DecodeSlot{ (uint16_t)f, (uint16_t)k, palette[i] };
+        }
+        cumulative += f;
+    }
+    if (cumulative != RANS_PROB_SCALE) {
+        return false;
+    }
+
+    const uint8_t *p   = src + head_size;
+    const uint8_t *end = src + size;
+    uint32_t x = read_u32(p);
+    p += 4;
+
+    const DecodeSlot *slots = g_codec_slots;
+    for (int i = 0; i < CHUNK_VOLUME; ++i) {
+        const DecodeSlot &slot = slots[x & (RANS_PROB_SCALE - 1)];
+        dst_zxy[i] = slot.material;
+        x = slot.freq * (x >> RANS_PROB_BITS) + slot.bias;
+        while (x < RANS_L) {
+            if (p == end) {
+                return false;
+            }
+            x = (x << 8) | *p++;
+        }
+    }
+    // The encoder started from RANS_L; anything else is a damaged stream.
+    return x == RANS_L && p == end;
+}
+
+// -----------------------------------------------------------------------------
+// Encoding
+// -----------------------------------------------------------------------------
+
+bool encode(const uint8_t *src_zxy, Codec codec, std::vector<uint8_t> &out) {
+    switch (codec) {
+        case CODEC_RAW:
+            out.resize(RAW_SIZE);
+            out[0] = CODEC_RAW;
+            memcpy(out.data() + 1, src_zxy, CHUNK_VOLUME);
+            return true;
+
+        case CODEC_RLE: {
+            const size_t size = encode_rle_stream(src_zxy);
+            out.resize(1 + size);
+            out[0] = CODEC_RLE;
+            memcpy(out.data() + 1, g_codec_rle, size);
+            return true;
+        }
+
+        case CODEC_RLE_FASTLZ:
+        case CODEC_RLE_DEFLATE:
+        case CODEC_RLE_ZSTD: {
+            const size_t size = encode_rle_stream(src_zxy);
+            return pack_rle(g_codec_rle, size, codec, out);
+        }
+
+        case CODEC_PALETTE_RANS:
+            encode_palette_rans(src_zxy, out);
+            return true;
+
+        default:
+            return false;   // CODEC_GENERATOR_DIFF needs a base
+    }
+}
+
+Codec encode_auto(const uint8_t *src_zxy, Policy policy, std::vector<uint8_t> &out) {
+    const size_t rle_size = encode_rle_stream(src_zxy);
+    out.resize(1 + rle_size);
+    out[0] = CODEC_RLE;
+    memcpy(out.data() + 1, g_codec_rle, rle_size);
+    Codec best = CODEC_RLE;
+
+    Codec candidates[CODEC_COUNT];
+    int candidate_count = 0;
+    if (policy == POLICY_SMALLEST) {
+        candidates[candidate_count++] = CODEC_RLE_FASTLZ;
+        candidates[candidate_count++] = CODEC_RLE_DEFLATE;
+        candidates[candidate_count++] = CODEC_RLE_ZSTD;
+        candidates[candidate_count++] = CODEC_PALETTE_RANS;
+    } else if (policy == POLICY_BALANCED && rle_size > BALANCED_RLE_THRESHOLD) {
+        candidates[candidate_count++] = CODEC_RLE_ZSTD;
+        candidates[candidate_count++] = CODEC_PALETTE_RANS;
+    }
+
+    for (int i = 0; i < candidate_count; ++i) {
+        const Codec codec = candidates[i];
+        bool ok;
+        if (is_packed_rle(codec)) {
+            ok = pack_rle(g_codec_rle, rle_size, codec, g_codec_candidate);
+        } else {
+            encode_palette_rans(src_zxy, g_codec_candidate);
+            ok = true;
+        }
+        if (ok && g_codec_candidate.size() < out.size()) {
+            out.swap(g_codec_candidate);
+            best = codec;
+        }
+    }
+
+    if (out.size() > RAW_SIZE) {
+        encode(src_zxy, CODEC_RAW, out);
+        best = CODEC_RAW;
+    }
+    return best;
+}
+
+Codec encode_diff(const uint8_t *src_zxy, const uint8_t *base_zxy, uint32_t base_key, Policy policy,
+        std::vector<uint8_t> &out) {
+    xor_chunk(src_zxy, base_zxy, g_codec_diff);
+    const Codec inner = encode_auto(g_codec_diff, policy, g_codec_inner);
+
+    out.resize(DIFF_HEAD + g_codec_inner.size());
+    out[0] = CODEC_GENERATOR_DIFF;
+    write_u32(out.data() + 1, base_key);
+    memcpy(out.data() + DIFF_HEAD, g_codec_inner.data(), g_codec_inner.size());
+    return inner;
+}
+
+void add_flags(const uint8_t *flags_zxy, Policy policy, std::vector<uint8_t> &payload) {
+    encode_auto(flags_zxy, policy, g_codec_inner);
+
+    const size_t material_size = payload.size();
+    payload.resize(FLAGS_HEAD + material_size + g_codec_inner.size());
+    memmove(payload.data() + FLAGS_HEAD, payload.data(), material_size);
+    payload[0] = FLAGS_RECORD;
+    write_u32(payload.data() + 1, uint32_t(material_size));
+    memcpy(payload.data() + FLAGS_HEAD + material_size, g_codec_inner.data(), g_codec_inner.size());
+}
+
+// -----------------------------------------------------------------------------
+// Decoding
+// -----------------------------------------------------------------------------
+
+bool get_diff_base_key(const uint8_t *src, size_t size, uint32_t &out) {
+    src = material_section(src, size);
+    if (size < DIFF_HEAD || src[0] != CODEC_GENERATOR_DIFF) {
+        return false;
+    }
+    out = read_u32(src + 1);
+    return true;
+}
+
+Codec get_codec(const uint8_t *src, size_t size) {
+    src = material_section(src, size);
+    if (size == 0) {
+        return CODEC_COUNT;
+    }
+    if (src[0] == CODEC_LEGACY_RLE) {
+        return CODEC_LEGACY_RLE;
+    }
+    return src[0] < CODEC_COUNT ? Codec(src[0]) : CODEC_COUNT;
+}
+
+bool decode(const uint8_t *src, size_t size, uint8_t *dst_zxy, const uint8_t *base_zxy) {
+    src = material_section(src, size);
+    const Codec codec = get_codec(src, size);
+    switch (codec) {
+        case CODEC_RAW:
+            if (size != RAW_SIZE) {
+                return false;
+            }
+            memcpy(dst_zxy, src + 1, CHUNK_VOLUME);
+            return true;
+
+        case CODEC_RLE:
+            return voxel_rle::decode(src + 1, size - 1, dst_zxy, CHUNK_VOLUME);
+
+        case CODEC_RLE_FASTLZ:
+        case CODEC_RLE_DEFLATE:
+        case CODEC_RLE_ZSTD:
+            return unpack_rle(src, size, codec, dst_zxy);
+
+        case CODEC_PALETTE_RANS:
+            return decode_palette_rans(src, size, dst_zxy);
+
+        case CODEC_GENERATOR_DIFF:
+            // The XOR is never itself a diff, so this recurses once at most.
+            if (base_zxy == nullptr || size <= DIFF_HEAD || src[DIFF_HEAD] == CODEC_GENERATOR_DIFF
+                    || src[DIFF_HEAD] == FLAGS_RECORD || !decode(src + DIFF_HEAD, size - DIFF_HEAD, dst_zxy, nullptr)) {
+                return false;
+            }
+            xor_chunk(dst_zxy, base_zxy, dst_zxy);
+            return true;
+
+        case CODEC_LEGACY_RLE:
+            return voxel_rle::decode(src, size, dst_zxy, CHUNK_VOLUME);
+
+        default:
+            return false;
+    }
+}
+
+bool has_flags(const uint8_t *src, size_t size) {
+    return size > 0 && src[0] == FLAGS_RECORD;
+}
+
+bool decode_flags(const uint8_t *src, size_t size, uint8_t *dst_zxy) {
+    if (!has_flags(src, size)) {
+        memset(dst_zxy, 0, CHUNK_VOLUME);
+        return true;
+    }
+    if (size < FLAGS_HEAD || read_u32(src + 1) > size - FLAGS_HEAD) {
+        return false;
+    }
+    const size_t offset = FLAGS_HEAD + read_u32(src + 1);
+    if (offset == size || src[offset] == CODEC_GENERATOR_DIFF || src[offset] == FLAGS_RECORD) {
+        return false;
+    }
+    return decode(src + offset, size - offset, dst_zxy, nullptr);
+}
+
+const char *get_codec_name(Codec codec) {
+    switch (codec) {
+        case CODEC_RAW:             return "raw";
+        case CODEC_RLE:             return "rle";
+        case CODEC_RLE_FASTLZ:      return "rle+fastlz";
+        case CODEC_RLE_DEFLATE:     return "rle+deflate";
+        case CODEC_RLE_ZSTD:        return "rle+zstd";
+        case CODEC_PALETTE_RANS:    return "palette+rans";
+        case CODEC_GENERATOR_DIFF:  return "generator diff";
+        case CODEC_LEGACY_RLE:      return "rle (untagged)";
+        default:                    return "unknown";
+    }
+}
+
+} // namespace voxel_codec
@@ -0,0 +1,129 @@
+// voxel_codec.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/// Per-chunk payload codecs for saved chunks.
+///
+/// A payload is one codec id byte followed by the codec's body, so every
+/// chunk in a save can use a different codec and readers dispatch on the
+/// first byte:
+///
+///   CODEC_RAW            64^3 ZXY material bytes as they are
+///   CODEC_RLE            voxel_rle.h v3 stream (best scan order)
+///   CODEC_RLE_FASTLZ     RLE stream, then Godot's FastLZ
+///   CODEC_RLE_DEFLATE    RLE stream, then Godot's deflate
+///   CODEC_RLE_ZSTD       RLE stream, then Godot's zstd
+///   CODEC_PALETTE_RANS   palette of the materials present, then the
+///                        palette index of every voxel coded with static
+///                        order-0 rANS (12-bit probabilities)
+///   CODEC_GENERATOR_DIFF chunk XOR a base chunk (what the terrain
+///                        generator makes there): the base's key (uint32),
+///                        then that XOR as a payload of any other codec
+///
+/// The compressed RLE bodies start with the RLE stream's size (uint32) so
+/// the decompressor knows its output size. The rANS body is the palette
+/// size minus one (uint8), the palette, the quantized frequency of each
+/// palette entry (uint16) and the rANS byte stream; a single-entry palette
+/// has no stream at all. Everything is little endian.
+///
+/// RLE is near free to decode and wins on terrain; the general purpose
+/// compressors squeeze the RLE stream of busy chunks further, and the rANS
+/// coder is the better fit for noisy underground chunks (ores, gravel)
+/// whose runs are too short for RLE to help at all. encode_auto() picks per
+/// chunk under a Policy.
+///
+/// A diff is zero wherever the chunk still matches its base, so a handful
+/// of edits in generated terrain costs a few bytes whichever codec carries
+/// it; decoding it needs the base again (see encode_diff()).
+///
+/// Payloads written before codecs existed are bare RLE streams; they start
+/// with the v2/v3 header byte 0xFF, which is never a codec id, and still
+/// decode.
+///
+/// A chunk with per-voxel flags set is saved as a flags record: the byte
+/// FLAGS_RECORD, the size of the material payload (uint32), the material
+/// payload, then the flags as a payload of their own (never a diff). The
+/// decoding functions below see through the record to the materials;
+/// decode_flags() reads the flags section.
+namespace voxel_codec {
+
+static constexpr int CHUNK_VOLUME = 64 * 64 * 64;
+
+enum Codec : uint8_t {
+    CODEC_RAW,
+    CODEC_RLE,
+    CODEC_RLE_FASTLZ,
+    CODEC_RLE_DEFLATE,
+    CODEC_RLE_ZSTD,
+    CODEC_PALETTE_RANS,
+    CODEC_GENERATOR_DIFF,
+    CODEC_COUNT,
+    CODEC_LEGACY_RLE = 0xFF,   // untagged voxel_rle stream
+};
+
+/// First byte of a flags record; never a codec id.
+static constexpr uint8_t FLAGS_RECORD = 0xFE;
+
+enum Policy : uint8_t {
+    /// RLE only: the cheapest to encode and decode.
+    POLICY_FASTEST,
+    /// RLE, plus zstd and rANS for chunks whose RLE stream is larger than
+    /// BALANCED_RLE_THRESHOLD; the smallest result wins.
+    POLICY_BALANCED,
+    /// Every codec; the smallest result wins.
+    POLICY_SMALLEST,
+};
+
+/// RLE size above which POLICY_BALANCED tries the slower codecs. Surface
+/// and air chunks stay well below it.
+static constexpr size_t BALANCED_RLE_THRESHOLD = 4096;
+
+/// Encode a 64^3 ZXY chunk with `codec` into `out` (replaced). Returns
+/// false for an unknown codec, for CODEC_GENERATOR_DIFF (use
+/// encode_diff()) or a failed compression.
+bool encode(const uint8_t *src_zxy, Codec codec, std::vector<uint8_t> &out);
+
+/// Encode with whichever codec the policy finds smallest. Falls back to
+/// CODEC_RAW when nothing beats it. Returns the codec used.
+Codec encode_auto(const uint8_t *src_zxy, Policy policy, std::vector<uint8_t> &out);
+
+/// Encode `src_zxy` as a CODEC_GENERATOR_DIFF against `base_zxy`, the XOR
+/// carried by whichever codec `policy` picks. `base_key` identifies the
+/// base (e.g. the generator's settings hash) so a reader can tell whether
+/// it can rebuild it. Returns the codec carrying the XOR.
+Codec encode_diff(const uint8_t *src_zxy, const uint8_t *base_zxy, uint32_t base_key, Policy policy,
+        std::vector<uint8_t> &out);
+
+/// Turn `payload` (a material payload) into a flags record carrying the
+/// 64^3 ZXY `flags_zxy`, encoded with whichever codec `policy` picks.
+void add_flags(const uint8_t *flags_zxy, Policy policy, std::vector<uint8_t> &payload);
+
+/// `base_key` of a CODEC_GENERATOR_DIFF payload; false for anything else.
+bool get_diff_base_key(const uint8_t *src, size_t size, uint32_t &out);
+
+/// Codec of a payload (CODEC_LEGACY_RLE for untagged RLE), or CODEC_COUNT
+/// if it is empty or names a codec this build does not know.
+Codec get_codec(const uint8_t *src, size_t size);
+
+/// Decode a payload of any codec into a 64^3 ZXY buffer. A diff needs the
+/// `base_zxy` it was encoded against. Returns false if the payload is
+/// malformed or a diff comes without a base; `dst_zxy` may then be partly
+/// written.
+bool decode(const uint8_t *src, size_t size, uint8_t *dst_zxy, const uint8_t *base_zxy = nullptr);
+
+/// Whether a payload is a flags record.
+bool has_flags(const uint8_t *src, size_t size);
+
+/// Decode the flags section of a flags record into a 64^3 ZXY buffer; a
+/// payload without one decodes to all zero flags. Returns false if the
+/// record is malformed.
+bool decode_flags(const uint8_t *src, size_t size, uint8_t *dst_zxy);
+
+/// Short lowercase name ("raw", "rle", "rle+zstd", ...).
+const char *get_codec_name(Codec codec);
+
+} // namespace voxel_codec
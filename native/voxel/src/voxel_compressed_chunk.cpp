@@ -0,0 +1,163 @@
+// voxel_compressed_chunk.cpp
+
+#include "voxel_compressed_chunk.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+static constexpr int N = VoxelChunk::SIZE;
+
+// Axes (0 = x, 1 = y, 2 = z) of each linear scan order, fastest first.
+static constexpr int ORDER_AXES[voxel_rle::ORDER_MORTON][3] = {
+    { 2, 0, 1 },   // ORDER_ZXY
+    { 0, 1, 2 },   // ORDER_XYZ
+    { 1, 0, 2 },   // ORDER_YXZ
+};
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelCompressedChunk::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_rle", "rle"), &VoxelCompressedChunk::set_rle);
+    ClassDB::bind_method(D_METHOD("get_rle"), &VoxelCompressedChunk::get_rle);
+    ClassDB::bind_method(D_METHOD("compress", "chunk"), &VoxelCompressedChunk::compress);
+    ClassDB::bind_method(D_METHOD("decompress"), &VoxelCompressedChunk::decompress);
+    ClassDB::bind_method(D_METHOD("is_empty"), &VoxelCompressedChunk::is_empty);
+
+    ClassDB::bind_method(D_METHOD("get_voxel", "x", "y", "z"), &VoxelCompressedChunk::get_voxel);
+    ClassDB::bind_method(D_METHOD("get_region", "from", "to"), &VoxelCompressedChunk::get_region);
+    ClassDB::bind_method(D_METHOD("get_memory_usage"), &VoxelCompressedChunk::get_memory_usage);
+}
+
+// -----------------------------------------------------------------------------
+// Data
+// -----------------------------------------------------------------------------
+
+bool VoxelCompressedChunk::set_rle(const PackedByteArray &p_rle) {
+    std::vector<voxel_rle::IndexEntry> p_index;
+    const bool valid = voxel_rle::build_index(p_rle.ptr(), p_rle.size(), VoxelChunk::VOXEL_COUNT, p_index);
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    if (!valid) {
+        rle = PackedByteArray();
+        index.clear();
+        order = voxel_rle::ORDER_ZXY;
+        return false;
+    }
+    rle   = p_rle;
+    index = std::move(p_index);
+    order = voxel_rle::get_order(rle.ptr(), rle.size());
+    return true;
+}
+
+PackedByteArray VoxelCompressedChunk::get_rle() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return rle;
+}
+
+void VoxelCompressedChunk::compress(const Ref<VoxelChunk> &chunk) {
+    ERR_FAIL_COND_MSG(chunk.is_null(), "compress() needs a chunk.");
+    set_rle(chunk->encode_rle());
+}
+
+Ref<VoxelChunk> VoxelCompressedChunk::decompress() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    if (index.empty()) {
+        return Ref<VoxelChunk>();
+    }
+
+    Ref<VoxelChunk> chunk;
+    chunk.instantiate();
+    chunk->decode_rle(rle);
+    return chunk;
+}
+
+bool VoxelCompressedChunk::is_empty() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return index.empty();
+}
+
+int64_t VoxelCompressedChunk::get_memory_usage() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return (int64_t)(rle.size() + index.capacity() * sizeof(voxel_rle::IndexEntry));
+}
+
+// -----------------------------------------------------------------------------
+// Random access
+// -----------------------------------------------------------------------------
+
+int VoxelCompressedChunk::get_voxel(int x, int y, int z) const {
+    if ((unsigned)x >= (unsigned)N || (unsigned)y >= (unsigned)N || (unsigned)z >= (unsigned)N) {
+        return 0;
+    }
+
+    std::shared_lock<std::shared_mutex> guard(lock);
+    if (index.empty()) {
+        return 0;
+    }
+    return voxel_rle::read_at(rle.ptr(), rle.size(), index, voxel_rle::order_position(order, x, y, z));
+}
+
+PackedByteArray VoxelCompressedChunk::get_region(const Vector3i &from, const Vector3i &to) const {
+    PackedByteArray out;
+
+    const int lo[3] = { std::max(from.x, 0), std::max(from.y, 0), std::max(from.z, 0) };
+    const int hi[3] = { std::min(to.x, N), std::min(to.y, N), std::min(to.z, N) };
+    if (lo[0] >= hi[0] || lo[1] >= hi[1] || lo[2] >= hi[2]) {
+        return out;
+    }
+
+    std::shared_lock<std::shared_mutex> guard(lock);
+    if (index.empty()) {
+        return out;
+    }
+
+    const int w = hi[0] - lo[0];
+    const int h = hi[1] - lo[1];
+    const int out_stride[3] = { 1, w, w * h };
+
+    out.resize(int64_t(w) * h * (hi[2] - lo[2]));
+    uint8_t *dst = out.ptrw();
+    const uint8_t *src = rle.ptr();
+    const size_t size = rle.size();
+
+    if (order == voxel_rle::ORDER_MORTON) {
+        for (int z = lo[2]; z < hi[2]; ++z) {
+            for (int y = lo[1]; y < hi[1]; ++y) {
+                for (int x = lo[0]; x < hi[0]; ++x) {
+                    *dst++ = voxel_rle::read_at(src, size, index, voxel_rle::order_position(order, x, y, z));
+                }
+            }
+        }
+        return out;
+    }
+
+    // One seek per row of the fastest axis; the row is contiguous in the stream.
+    const int *axes = ORDER_AXES[order];
+    const int a = axes[0];
+    const int length = hi[a] - lo[a];
+    uint8_t row[N];
+
+    int v[3];
+    v[a] = lo[a];
+    for (v[axes[2]] = lo[axes[2]]; v[axes[2]] < hi[axes[2]]; ++v[axes[2]]) {
+        for (v[axes[1]] = lo[axes[1]]; v[axes[1]] < hi[axes[1]]; ++v[axes[1]]) {
+            voxel_rle::read_range(src, size, index, voxel_rle::order_position(order, v[0], v[1], v[2]), length, row);
+
+            uint8_t *base = dst + (v[0] - lo[0]) + (v[1] - lo[1]) * out_stride[1] + (v[2] - lo[2]) * out_stride[2];
+            for (int k = 0; k < length; ++k) {
+                base[k * out_stride[a]] = row[k];
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,61 @@
+// voxel_compressed_chunk.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "voxel_chunk.h"
+#include "voxel_rle.h"
+
+using namespace godot;
+
+/// A chunk kept in its run-length encoded save form (VoxelChunk::encode_rle)
+/// for cold data: far away, or only queried by raycasts and gameplay.
+///
+/// A sparse run index (voxel_rle::build_index) is built once when the data
+/// is set, so get_voxel() and get_region() seek into the stream with a
+/// binary search instead of decoding all 64^3 voxels. Coordinates are local
+/// 0..63 like VoxelChunk; out of range reads return 0.
+class VoxelCompressedChunk : public RefCounted {
+    GDCLASS(VoxelCompressedChunk, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    VoxelCompressedChunk() = default;
+    ~VoxelCompressedChunk() = default;
+
+    /// Take encoded chunk data (any voxel_rle.h version). Returns false,
+    /// leaving this empty, if it does not decode to a whole chunk.
+    bool set_rle(const PackedByteArray &rle);
+    PackedByteArray get_rle() const;
+
+    /// Encode `chunk` (VoxelChunk::encode_rle) and index it.
+    void compress(const Ref<VoxelChunk> &chunk);
+
+    /// Full decode into a new VoxelChunk (null if empty).
+    Ref<VoxelChunk> decompress() const;
+
+    bool is_empty() const;
+
+    int get_voxel(int x, int y, int z) const;
+
+    /// Materials in the box [from, to) clipped to the chunk, in XYZ layout
+    /// relative to the clipped box (idx = x + y*w + z*w*h).
+    PackedByteArray get_region(const Vector3i &from, const Vector3i &to) const;
+
+    /// Bytes held by the stream and its index.
+    int64_t get_memory_usage() const;
+
+private:
+    mutable std::shared_mutex            lock;
+    PackedByteArray                      rle;
+    std::vector<voxel_rle::IndexEntry>   index;
+    voxel_rle::Order                     order = voxel_rle::ORDER_ZXY;
+};
@@ -0,0 +1,341 @@
+// voxel_edit.cpp
+
+#include "voxel_edit.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+static constexpr int N = VoxelChunk::SIZE;
+
+// Per-thread decode buffer for the chunk being edited.
+static thread_local uint8_t  g_edit_scratch_zxy[VoxelChunk::VOXEL_COUNT];
+static thread_local uint64_t g_edit_column_masks[voxel_shapes::COLUMN_COUNT];
+
+static inline bool box_is_empty(const Vector3i &from, const Vector3i &to) {
+    return from.x >= to.x || from.y >= to.y || from.z >= to.z;
+}
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelEdit::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_voxel", "voxel", "material"), &VoxelEdit::set_voxel);
+    ClassDB::bind_method(D_METHOD("fill_box", "from", "to", "material"), &VoxelEdit::fill_box);
+    ClassDB::bind_method(D_METHOD("replace", "from", "to", "from_material", "to_material"), &VoxelEdit::replace);
+
+    ClassDB::bind_method(D_METHOD("sphere", "center", "radius", "material"), &VoxelEdit::sphere);
+    ClassDB::bind_method(D_METHOD("box", "center", "half_extents", "material"), &VoxelEdit::box);
+    ClassDB::bind_method(D_METHOD("capsule", "a", "b", "radius", "material"), &VoxelEdit::capsule);
+    ClassDB::bind_method(D_METHOD("cylinder", "a", "b", "radius", "material"), &VoxelEdit::cylinder);
+    ClassDB::bind_method(D_METHOD("noise_sphere", "center", "radius", "amplitude", "frequency", "seed", "material"), &VoxelEdit::noise_sphere);
+
+    ClassDB::bind_method(D_METHOD("stamp", "prefab", "position", "mode"), &VoxelEdit::stamp, DEFVAL(VoxelPrefab::STAMP_REPLACE_AIR));
+
+    ClassDB::bind_method(D_METHOD("get_operation_count"), &VoxelEdit::get_operation_count);
+    ClassDB::bind_method(D_METHOD("clear"), &VoxelEdit::clear);
+    ClassDB::bind_method(D_METHOD("commit"), &VoxelEdit::commit);
+}
+
+// -----------------------------------------------------------------------------
+// Recording
+// -----------------------------------------------------------------------------
+
+void VoxelEdit::set_voxel(const Vector3i &voxel, int material) {
+    fill_box(voxel, voxel + Vector3i(1, 1, 1), material);
+}
+
+void VoxelEdit::fill_box(const Vector3i &from, const Vector3i &to, int material) {
+    if (box_is_empty(from, to)) {
+        return;
+    }
+    Operation op;
+    op.from     = from;
+    op.to       = to;
+    op.type     = OP_FILL;
+    op.material = (uint8_t)material;
+    op.match    = 0;
+    op.shape    = 0;
+    operations.push_back(op);
+}
+
+void VoxelEdit::replace(const Vector3i &from, const Vector3i &to, int from_material, int to_material) {
+    if (box_is_empty(from, to) || from_material == to_material) {
+        return;
+    }
+    Operation op;
+    op.from     = from;
+    op.to       = to;
+    op.type     = OP_REPLACE;
+    op.material = (uint8_t)to_material;
+    op.match    = (uint8_t)from_material;
+    op.shape    = 0;
+    operations.push_back(op);
+}
+
+void VoxelEdit::add_shape(const voxel_shapes::Shape &shape, int material) {
+    int bmin[3];
+    int bmax[3];
+    voxel_shapes::get_bounds(shape, bmin, bmax);
+
+    Operation op;
+    op.from     = Vector3i(bmin[0], bmin[1], bmin[2]);
+    op.to       = Vector3i(bmax[0], bmax[1], bmax[2]);
+    op.type     = OP_SHAPE;
+    op.material = (uint8_t)material;
+    op.match    = 0;
+    op.shape    = shapes.size();
+
+    shapes.push_back(shape);
+    operations.push_back(op);
+}
+
+static inline void set_point(double out[3], const Vector3 &v) {
+    out[0] = v.x;
+    out[1] = v.y;
+    out[2] = v.z;
+}
+
+void VoxelEdit::sphere(const Vector3 &center, float radius, int material) {
+    if (radius <= 0.0f) {
+        return;
+    }
+    voxel_shapes::Shape shape;
+    shape.type   = voxel_shapes::SHAPE_SPHERE;
+    shape.radius = radius;
+    set_point(shape.a, center);
+    add_shape(shape, material);
+}
+
+void VoxelEdit::box(const Vector3 &center, const Vector3 &half_extents, int material) {
+    if (half_extents.x < 0.0f || half_extents.y < 0.0f || half_extents.z < 0.0f) {
+        return;
+    }
+    voxel_shapes::Shape shape;
+    shape.type = voxel_shapes::SHAPE_BOX;
+    set_point(shape.a, center);
+    set_point(shape.b, half_extents);
+    add_shape(shape, material);
+}
+
+void VoxelEdit::capsule(const Vector3 &a, const Vector3 &b, float radius, int material) {
+    if (radius <= 0.0f) {
+        return;
+    }
+    voxel_shapes::Shape shape;
+    shape.type   = voxel_shapes::SHAPE_CAPSULE;
+    shape.radius = radius;
+    set_point(shape.a, a);
+    set_point(shape.b, b);
+    add_shape(shape, material);
+}
+
+void VoxelEdit::cylinder(const Vector3 &a, const Vector3 &b, float radius, int material) {
+    if (radius <= 0.0f || a == b) {
+        return;
+    }
+    voxel_shapes::Shape shape;
+    shape.type   = voxel_shapes::SHAPE_CYLINDER;
+    shape.radius = radius;
+    set_point(shape.a, a);
+    set_point(shape.b, b);
+    add_shape(shape, material);
+}
+
+void VoxelEdit::noise_sphere(const Vector3 &center, float radius, float amplitude, float frequency, int seed, int material) {
+    if (radius <= 0.0f) {
+        return;
+    }
+    voxel_shapes::Shape shape;
+    shape.type            = voxel_shapes::SHAPE_NOISE_SPHERE;
+    shape.radius          = radius;
+    shape.noise_amplitude = amplitude;
+    shape.noise_frequency = frequency;
+    shape.seed            = (uint32_t)seed;
+    set_point(shape.a, center);
+    add_shape(shape, material);
+}
+
+void VoxelEdit::stamp(const Ref<VoxelPrefab> &prefab, const Vector3i &position, VoxelPrefab::StampMode mode) {
+    ERR_FAIL_COND_MSG(prefab.is_null(), "stamp() needs a prefab.");
+    if (prefab->get_run_count() == 0) {
+        return;
+    }
+    Operation op;
+    op.from     = position;
+    op.to       = position + prefab->get_size();
+    op.type     = OP_STAMP;
+    op.material = 0;
+    op.match    = (uint8_t)mode;
+    op.shape    = prefabs.size();
+
+    prefabs.push_back(prefab);
+    operations.push_back(op);
+}
+
+// -----------------------------------------------------------------------------
+// Commit
+// -----------------------------------------------------------------------------
+
+bool VoxelEdit::apply_operation(const Operation &op, const Vector3i &origin, uint8_t *voxels_zxy,
+        Vector3i &dirty_min, Vector3i &dirty_max) const {
+    const Vector3i lo = (op.from - origin).max(Vector3i(0, 0, 0));
+    const Vector3i hi = (op.to - origin).min(Vector3i(N, N, N));
+    if (box_is_empty(lo, hi)) {
+        return false;
+    }
+
+    if (op.type == OP_SHAPE) {
+        const int origin_v[3] = { origin.x, origin.y, origin.z };
+        const int lo_v[3]     = { lo.x, lo.y, lo.z };
+        const int hi_v[3]     = { hi.x, hi.y, hi.z };
+
+        if (!voxel_shapes::rasterize(shapes[op.shape], origin_v, lo_v, hi_v, g_edit_column_masks)) {
+            return false;
+        }
+
+        int dmin[3];
+        int dmax[3];
+        if (!voxel_shapes::apply_masks(g_edit_column_masks, lo_v, hi_v, op.material, voxels_zxy, dmin, dmax)) {
+            return false;
+        }
+        dirty_min = Vector3i(dmin[0], dmin[1], dmin[2]);
+        dirty_max = Vector3i(dmax[0], dmax[1], dmax[2]);
+        return true;
+    }
+
+    if (op.type == OP_STAMP) {
+        return prefabs[op.shape]->blit_zxy(voxels_zxy, op.from - origin, lo, hi,
+                (VoxelPrefab::StampMode)op.match, dirty_min, dirty_max);
+    }
+
+    const int len     = hi.z - lo.z;
+    bool      changed = false;
+
+    for (int y = lo.y; y < hi.y; ++y) {
+        for (int x = lo.x; x < hi.x; ++x) {
+            // z runs fastest: each (x, y) row of the box is contiguous.
+            uint8_t *row = voxels_zxy + VoxelPaletteStorage::index_zxy(x, y, lo.z);
+
+            int first = -1;
+            int last  = -1;
+
+            if (op.type == OP_FILL) {
+                for (int k = 0; k < len; ++k) {
+                    if (row[k] != op.material) {
+                        if (first < 0) first = k;
+                        last = k;
+                    }
+                }
+                if (first >= 0) {
+                    memset(row + first, op.material, last - first + 1);
+                }
+            } else {
+                for (int k = 0; k < len; ++k) {
+                    if (row[k] == op.match) {
+                        row[k] = op.material;
+                        if (first < 0) first = k;
+                        last = k;
+                    }
+                }
+            }
+
+            if (first < 0) {
+                continue;
+            }
+
+            const Vector3i row_min(x, y, lo.z + first);
+            const Vector3i row_max(x, y, lo.z + last);
+            if (changed) {
+                dirty_min = dirty_min.min(row_min);
+                dirty_max = dirty_max.max(row_max);
+            } else {
+                dirty_min = row_min;
+                dirty_max = row_max;
+                changed   = true;
+            }
+        }
+    }
+
+    return changed;
+}
+
+TypedArray<Vector3i> VoxelEdit::commit() {
+    TypedArray<Vector3i> changed_chunks;
+
+    ERR_FAIL_COND_V_MSG(world.is_null(), changed_chunks, "VoxelEdit has no world; create it with VoxelWorld.begin_edit().");
+
+    if (operations.is_empty()) {
+        return changed_chunks;
+    }
+
+    // 1) Bucket operation indices by every chunk whose padded 64^3 box they
+    //    touch: chunk c covers world voxels [c*62 - 1, c*62 + 62].
+    HashMap<Vector3i, LocalVector<uint32_t>, VoxelChunkCoordHasher> buckets;
+    const int S = VoxelWorld::CHUNK_STRIDE;
+
+    for (uint32_t i = 0; i < operations.size(); ++i) {
+        const Operation &op = operations[i];
+        const Vector3i cmin(VoxelWorld::floor_div(op.from.x - 1, S), VoxelWorld::floor_div(op.from.y - 1, S), VoxelWorld::floor_div(op.from.z - 1, S));
+        const Vector3i cmax(VoxelWorld::floor_div(op.to.x, S), VoxelWorld::floor_div(op.to.y, S), VoxelWorld::floor_div(op.to.z, S));
+
+        for (int cy = cmin.y; cy <= cmax.y; ++cy) {
+            for (int cz = cmin.z; cz <= cmax.z; ++cz) {
+                for (int cx = cmin.x; cx <= cmax.x; ++cx) {
+                    buckets[Vector3i(cx, cy, cz)].push_back(i);
+                }
+            }
+        }
+    }
+
+    // 2) One decode / apply / re-pack per chunk.
+    for (const KeyValue<Vector3i, LocalVector<uint32_t>> &E : buckets) {
+        const Vector3i &coord = E.key;
+        const Ref<VoxelChunk> chunk = world->materialize_chunk(coord);
+        if (chunk.is_null()) {
+            continue;
+        }
+
+        const Vector3i origin = VoxelWorld::chunk_origin(coord);
+        const LocalVector<uint32_t> &ops = E.value;
+
+        Vector3i dirty_min;
+        Vector3i dirty_max;
+        bool     any_changed = false;
+
+        chunk->edit_materials_zxy(g_edit_scratch_zxy, [&](uint8_t *voxels_zxy) {
+            for (uint32_t i = 0; i < ops.size(); ++i) {
+                Vector3i op_min;
+                Vector3i op_max;
+                if (!apply_operation(operations[ops[i]], origin, voxels_zxy, op_min, op_max)) {
+                    continue;
+                }
+                if (any_changed) {
+                    dirty_min = dirty_min.min(op_min);
+                    dirty_max = dirty_max.max(op_max);
+                } else {
+                    dirty_min   = op_min;
+                    dirty_max   = op_max;
+                    any_changed = true;
+                }
+            }
+            return any_changed;
+        });
+
+        if (any_changed) {
+            world->mark_dirty(coord, dirty_min, dirty_max);
+            changed_chunks.push_back(coord);
+        }
+    }
+
+    clear();
+    return changed_chunks;
+}
@@ -0,0 +1,109 @@
+// voxel_edit.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+#include "voxel_prefab.h"
+#include "voxel_shapes.h"
+#include "voxel_world.h"
+
+using namespace godot;
+
+/// Batched voxel edit against a VoxelWorld (see VoxelWorld::begin_edit()).
+///
+/// Operations are only recorded until commit(). Commit buckets them by
+/// chunk, then for each affected chunk decodes its storage once, applies
+/// that chunk's operations in order, re-packs it and records the exact
+/// local bounds of the voxels that actually changed. Because world voxels on
+/// a chunk border are duplicated into the neighbours' padding, those
+/// neighbours are written and marked dirty too. Every changed chunk is
+/// queued for remeshing once, however many operations touched it.
+///
+/// All positions are world voxel coordinates; boxes are [from, to).
+/// Shapes take continuous world positions and fill every voxel whose centre
+/// (v + 0.5) is inside; they are rasterized per column (voxel_shapes.h).
+/// Use material 0 to carve. Prefabs are blitted run by run (VoxelPrefab),
+/// clipped to each chunk they overlap. Chunks that are not loaded are generated first
+/// if the world has a generator, and skipped otherwise.
+class VoxelEdit : public RefCounted {
+    GDCLASS(VoxelEdit, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    VoxelEdit() = default;
+    ~VoxelEdit() = default;
+
+    void set_voxel(const Vector3i &voxel, int material);
+    void fill_box(const Vector3i &from, const Vector3i &to, int material);
+
+    /// Turn every `from_material` voxel inside [from, to) into `to_material`.
+    void replace(const Vector3i &from, const Vector3i &to, int from_material, int to_material);
+
+    // --- Shapes ---
+
+    void sphere(const Vector3 &center, float radius, int material);
+    void box(const Vector3 &center, const Vector3 &half_extents, int material);
+    void capsule(const Vector3 &a, const Vector3 &b, float radius, int material);
+    void cylinder(const Vector3 &a, const Vector3 &b, float radius, int material);
+
+    /// Sphere whose surface is displaced by +/- amplitude of 3D gradient
+    /// noise sampled at world position * frequency (craters, explosions).
+    void noise_sphere(const Vector3 &center, float radius, float amplitude, float frequency, int seed, int material);
+
+    // --- Prefabs ---
+
+    /// Blit `prefab` with its (0, 0, 0) at world voxel `position`.
+    void stamp(const Ref<VoxelPrefab> &prefab, const Vector3i &position, VoxelPrefab::StampMode mode);
+
+    int get_operation_count() const { return (int)operations.size(); }
+
+    /// Drop all recorded operations without applying them.
+    void clear() {
+        operations.clear();
+        shapes.clear();
+        prefabs.clear();
+    }
+
+    /// Apply all recorded operations and return the coordinates of every
+    /// chunk that changed (already queued on the world for remeshing).
+    TypedArray<Vector3i> commit();
+
+    // --- Native access (not bound) ---
+
+    void set_world(const Ref<VoxelWorld> &owner) { world = owner; }
+
+private:
+    enum OperationType : uint8_t {
+        OP_FILL,     // also used for single voxels
+        OP_REPLACE,
+        OP_SHAPE,    // rasterized shapes[shape]
+        OP_STAMP,    // prefabs[shape] blitted with StampMode match
+    };
+
+    struct Operation {
+        Vector3i      from;
+        Vector3i      to;        // exclusive
+        OperationType type;
+        uint8_t       material;
+        uint8_t       match;     // OP_REPLACE: material to look for; OP_STAMP: mode
+        uint32_t      shape;     // OP_SHAPE: index into shapes; OP_STAMP: into prefabs
+    };
+
+    /// Apply `op` to the decoded chunk at `origin` (world position of local
+    /// 0,0,0). Grows [dirty_min, dirty_max] by the voxels that changed.
+    bool apply_operation(const Operation &op, const Vector3i &origin, uint8_t *voxels_zxy,
+            Vector3i &dirty_min, Vector3i &dirty_max) const;
+
+    void add_shape(const voxel_shapes::Shape &shape, int material);
+
+    Ref<VoxelWorld>                   world;
+    LocalVector<Operation>            operations;
+    LocalVector<voxel_shapes::Shape>  shapes;
+    LocalVector<Ref<VoxelPrefab>>     prefabs;
+};
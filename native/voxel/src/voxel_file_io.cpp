@@ -0,0 +1,187 @@
+// voxel_file_io.cpp
+
+#include "voxel_file_io.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Largest single transfer; bigger requests are split.
+static constexpr size_t MAX_TRANSFER = size_t(1) << 30;
+
+#ifdef _WIN32
+
+bool VoxelFileIO::open(const std::string &path, bool create) {
+    close();
+    const std::wstring wide = std::filesystem::u8path(path).wstring();
+    HANDLE h = CreateFileW(wide.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+            create ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    handle = h;
+    return true;
+}
+
+void VoxelFileIO::close() {
+    if (handle != nullptr) {
+        CloseHandle((HANDLE)handle);
+        handle = nullptr;
+    }
+}
+
+bool VoxelFileIO::is_open() const {
+    return handle != nullptr;
+}
+
+bool VoxelFileIO::read_at(uint64_t offset, void *dst, size_t size) const {
+    uint8_t *p = (uint8_t *)dst;
+    while (size > 0) {
+        const DWORD chunk = (DWORD)(size < MAX_TRANSFER ? size : MAX_TRANSFER);
+        OVERLAPPED at = {};
+        at.Offset     = (DWORD)(offset & 0xFFFFFFFFu);
+        at.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD got = 0;
+        if (!ReadFile((HANDLE)handle, p, chunk, &got, &at) || got == 0) {
+            return false;
+        }
+        p      += got;
+        offset += got;
+        size   -= got;
+    }
+    return true;
+}
+
+bool VoxelFileIO::write_at(uint64_t offset, const void *src, size_t size) {
+    const uint8_t *p = (const uint8_t *)src;
+    while (size > 0) {
+        const DWORD chunk = (DWORD)(size < MAX_TRANSFER ? size : MAX_TRANSFER);
+        OVERLAPPED at = {};
+        at.Offset     = (DWORD)(offset & 0xFFFFFFFFu);
+        at.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD put = 0;
+        if (!WriteFile((HANDLE)handle, p, chunk, &put, &at) || put == 0) {
+            return false;
+        }
+        p      += put;
+        offset += put;
+        size   -= put;
+    }
+    return true;
+}
+
+bool VoxelFileIO::sync() {
+    return FlushFileBuffers((HANDLE)handle) != 0;
+}
+
+uint64_t VoxelFileIO::get_size() const {
+    LARGE_INTEGER size;
+    return GetFileSizeEx((HANDLE)handle, &size) ? (uint64_t)size.QuadPart : 0;
+}
+
+bool VoxelFileIO::truncate(uint64_t size) {
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = (LONGLONG)size;
+    return SetFileInformationByHandle((HANDLE)handle, FileEndOfFileInfo, &info, sizeof(info)) != 0;
+}
+
+bool VoxelFileIO::replace(const std::string &from, const std::string &to) {
+    const std::wstring wide_from = std::filesystem::u8path(from).wstring();
+    const std::wstring wide_to   = std::filesystem::u8path(to).wstring();
+    return MoveFileExW(wide_from.c_str(), wide_to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+#else
+
+bool VoxelFileIO::open(const std::string &path, bool create) {
+    close();
+    fd = ::open(path.c_str(), O_RDWR | (create ? O_CREAT : 0), 0644);
+    return fd >= 0;
+}
+
+void VoxelFileIO::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool VoxelFileIO::is_open() const {
+    return fd >= 0;
+}
+
+bool VoxelFileIO::read_at(uint64_t offset, void *dst, size_t size) const {
+    uint8_t *p = (uint8_t *)dst;
+    while (size > 0) {
+        const ssize_t got = pread(fd, p, size < MAX_TRANSFER ? size : MAX_TRANSFER, (off_t)offset);
+        if (got <= 0) {
+            return false;
+        }
+        p      += got;
+        offset += (uint64_t)got;
+        size   -= (size_t)got;
+    }
+    return true;
+}
+
+bool VoxelFileIO::write_at(uint64_t offset, const void *src, size_t size) {
+    const uint8_t *p = (const uint8_t *)src;
+    while (size > 0) {
+        const ssize_t put = pwrite(fd, p, size < MAX_TRANSFER ? size : MAX_TRANSFER, (off_t)offset);
+        if (put <= 0) {
+            return false;
+        }
+        p      += put;
+        offset += (uint64_t)put;
+        size   -= (size_t)put;
+    }
+    return true;
+}
+
+bool VoxelFileIO::sync() {
+#ifdef __APPLE__
+    return fcntl(fd, F_FULLFSYNC) == 0 || fsync(fd) == 0;
+#else
+    return fsync(fd) == 0;
+#endif
+}
+
+uint64_t VoxelFileIO::get_size() const {
+    struct stat st;
+    return fstat(fd, &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+bool VoxelFileIO::truncate(uint64_t size) {
+    return ftruncate(fd, (off_t)size) == 0;
+}
+
+bool VoxelFileIO::replace(const std::string &from, const std::string &to) {
+    if (::rename(from.c_str(), to.c_str()) != 0) {
+        return false;
+    }
+
+    // The new name only survives a crash once the directory entry is on disk.
+    const size_t slash = to.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : to.substr(0, slash);
+    const int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd < 0) {
+        return false;
+    }
+    const bool ok = fsync(dir_fd) == 0;
+    ::close(dir_fd);
+    return ok;
+}
+
+#endif
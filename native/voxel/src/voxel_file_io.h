@@ -0,0 +1,46 @@
+// voxel_file_io.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+/// Positional file I/O (pread / pwrite on POSIX, overlapped ReadFile /
+/// WriteFile on Windows). There is no shared file cursor, so any number of
+/// threads may read and write disjoint ranges of one open file at once.
+class VoxelFileIO {
+public:
+    VoxelFileIO() = default;
+    VoxelFileIO(const VoxelFileIO &) = delete;
+    VoxelFileIO &operator=(const VoxelFileIO &) = delete;
+    ~VoxelFileIO() { close(); }
+
+    /// Open `path` (UTF-8) for reading and writing, creating it if `create`.
+    bool open(const std::string &path, bool create);
+    void close();
+    bool is_open() const;
+
+    /// Read or write exactly `size` bytes at `offset`; false on any error
+    /// or a short read past the end of the file.
+    bool read_at(uint64_t offset, void *dst, size_t size) const;
+    bool write_at(uint64_t offset, const void *src, size_t size);
+
+    /// Flush written data to the device (fsync / FlushFileBuffers).
+    bool sync();
+
+    uint64_t get_size() const;
+    bool truncate(uint64_t size);
+
+    /// Atomically rename `from` over `to` (both UTF-8) and make the rename
+    /// itself durable: the parent directory is synced on POSIX, and Windows
+    /// moves with MOVEFILE_WRITE_THROUGH.
+    static bool replace(const std::string &from, const std::string &to);
+
+private:
+#ifdef _WIN32
+    void *handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
@@ -1,6 +1,9 @@
 // voxel_greedy_mesher.cpp
 
 #include "voxel_greedy_mesher.h"
+#include "voxel_layout.h"
+#include "voxel_normals.h"
+#include "voxel_rle.h"
 
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/godot.hpp>
@@ -34,36 +37,6 @@ static thread_local uint8_t            g_forward_merged[CS_2];
 static thread_local uint8_t            g_right_merged[CS];
 static thread_local BM_VECTOR<uint64_t> g_vertices;
 
-// Caller layout XYZ: idx = x + y*64 + z*64*64
-static inline int src_index_xyz(int x, int y, int z) {
-    return x + y * VOX_SIZE + z * VOX_SIZE * VOX_SIZE;
-}
-
-// Mesher layout ZXY: z is fastest axis.
-static inline int dst_index_zxy(int z, int x, int y) {
-    return z + x * CS_P + y * CS_P2;
-}
-
-static inline void build_opaque_mask_from_voxels(const uint8_t *voxels_zxy, uint64_t *opaque_mask) {
-    for (int a = 0; a < CS_P; ++a) {
-        for (int b = 0; b < CS_P; ++b) {
-            const int column_index = a * CS_P + b;
-            const int base_index   = a * CS_P + b * CS_P2; // z runs fastest
-
-            uint64_t bits = 0;
-
-            for (int c = 0; c < CS_P; ++c) {
-                const uint8_t type = voxels_zxy[base_index + c];
-                if (type != 0) {
-                    bits |= (1ull << c);
-                }
-            }
-
-            opaque_mask[column_index] = bits;
-        }
-    }
-}
-
 static inline void ensure_mesh_data_initialized() {
     g_mesh_data.faceMasks     = g_face_masks;
     g_mesh_data.opaqueMask    = g_opaque_mask;
@@ -78,42 +51,25 @@ static inline void ensure_mesh_data_initialized() {
     }
 }
 
-// -----------------------------------------------------------------------------
-// Godot class implementation
-// -----------------------------------------------------------------------------
-
-void VoxelGreedyMesher::_bind_methods() {
-    ClassDB::bind_method(
-        D_METHOD("mesh_chunk_quads", "material64_xyz"),
-        &VoxelGreedyMesher::mesh_chunk_quads
-    );
-}
-
-PackedInt64Array VoxelGreedyMesher::mesh_chunk_quads(const PackedByteArray &material64_xyz) {
-    PackedInt64Array out;
-
-    // Expect exactly 64^3 bytes (your logical 62^3 lives inside this, with padding).
-    if (material64_xyz.size() != 64 * 64 * 64) {
-        return out;
+// Surface normals of whatever is currently in g_opaque_mask.
+static void normals_from_opaque_mask(PackedInt64Array &out) {
+    const int count = voxel_normals::count_surface_voxels(g_opaque_mask);
+    if (count <= 0) {
+        return;
     }
+    out.resize(count);
+    voxel_normals::compute_surface_normals(g_opaque_mask, out.ptrw());
+}
 
-    // 1) Copy XYZ -> ZXY (whatever you already had)
-    const uint8_t *src = material64_xyz.ptr();
-
-    for (int z = 0; z < VOX_SIZE; ++z) {
-        for (int x = 0; x < VOX_SIZE; ++x) {
-            for (int y = 0; y < VOX_SIZE; ++y) {
-                int src_idx = src_index_xyz(x, y, z);
-                int dst_idx = dst_index_zxy(z, x, y);
-                g_voxels_zxy[dst_idx] = src[src_idx];
-            }
-        }
+// Mesh whatever is currently in g_voxels_zxy and write the packed quads to `out`.
+// Pass opaque_mask_ready when g_opaque_mask was already filled by the producer.
+static void mesh_scratch_zxy(PackedInt64Array &out, bool opaque_mask_ready = false) {
+    // Build opaque mask
+    if (!opaque_mask_ready) {
+        voxel_layout::build_opaque_mask(g_voxels_zxy, g_opaque_mask);
     }
 
-    // 2) Build opaque mask
-    build_opaque_mask_from_voxels(g_voxels_zxy, g_opaque_mask);
-
-    // 3) Prepare MeshData and call Erik's mesher
+    // Prepare MeshData and call Erik's mesher
     ensure_mesh_data_initialized();
     BM_MEMSET(g_face_masks,     0, sizeof(g_face_masks));
     BM_MEMSET(g_forward_merged, 0, sizeof(g_forward_merged));
@@ -122,14 +78,14 @@ PackedInt64Array VoxelGreedyMesher::mesh_chunk_quads(const PackedByteArray &mate
 
     mesh(g_voxels_zxy, g_mesh_data);
 
-    // 4) Count quads per face
+    // Count quads per face
     int total_quads = 0;
     for (int face = 0; face < 6; ++face) {
         total_quads += g_mesh_data.faceVertexLength[face];
     }
 
     if (total_quads <= 0) {
-        return out;
+        return;
     }
 
     out.resize(total_quads);
@@ -149,6 +105,141 @@ PackedInt64Array VoxelGreedyMesher::mesh_chunk_quads(const PackedByteArray &mate
             out.set(dst++, (int64_t)packed);
         }
     }
+}
 
+// -----------------------------------------------------------------------------
+// Godot class implementation
+// -----------------------------------------------------------------------------
+
+void VoxelGreedyMesher::_bind_methods() {
+    ClassDB::bind_method(
+        D_METHOD("mesh_chunk_quads", "material64_xyz"),
+        &VoxelGreedyMesher::mesh_chunk_quads
+    );
+    ClassDB::bind_method(
+        D_METHOD("mesh_chunk", "chunk"),
+        &VoxelGreedyMesher::mesh_chunk
+    );
+    ClassDB::bind_method(
+        D_METHOD("mesh_chunk_rle", "rle"),
+        &VoxelGreedyMesher::mesh_chunk_rle
+    );
+    ClassDB::bind_method(
+        D_METHOD("mesh_generated", "generator", "chunk_coord"),
+        &VoxelGreedyMesher::mesh_generated
+    );
+    ClassDB::bind_method(
+        D_METHOD("compute_normals", "material64_xyz"),
+        &VoxelGreedyMesher::compute_normals
+    );
+    ClassDB::bind_method(
+        D_METHOD("compute_chunk_normals", "chunk"),
+        &VoxelGreedyMesher::compute_chunk_normals
+    );
+    ClassDB::bind_static_method(
+        "VoxelGreedyMesher",
+        D_METHOD("decode_normal", "packed"),
+        &VoxelGreedyMesher::decode_normal
+    );
+}
+
+PackedInt64Array VoxelGreedyMesher::mesh_chunk_quads(const PackedByteArray &material64_xyz) {
+    PackedInt64Array out;
+
+    // Expect exactly 64^3 bytes (your logical 62^3 lives inside this, with padding).
+    if (material64_xyz.size() != 64 * 64 * 64) {
+        return out;
+    }
+
+    // 1) Copy XYZ -> ZXY (whatever you already had)
+    voxel_layout::xyz_to_zxy(material64_xyz.ptr(), g_voxels_zxy);
+
+    // 2) Mesh the scratch buffer
+    mesh_scratch_zxy(out);
     return out;
 }
+
+PackedInt64Array VoxelGreedyMesher::mesh_chunk(const Ref<VoxelChunk> &chunk) {
+    PackedInt64Array out;
+
+    if (chunk.is_null()) {
+        return out;
+    }
+
+    // Chunk storage is already ZXY: decode straight into the mesher scratch.
+    chunk->unpack_materials_zxy(g_voxels_zxy);
+
+    mesh_scratch_zxy(out);
+    return out;
+}
+
+PackedInt64Array VoxelGreedyMesher::mesh_chunk_rle(const PackedByteArray &rle) {
+    PackedInt64Array out;
+
+    if (!voxel_rle::decode_opaque(rle.ptr(), rle.size(), g_voxels_zxy, VOX_COUNT, g_opaque_mask)) {
+        return out;
+    }
+
+    mesh_scratch_zxy(out, true);
+    return out;
+}
+
+PackedInt64Array VoxelGreedyMesher::mesh_generated(const Ref<VoxelTerrainGenerator> &generator, const Vector3i &chunk_coord) {
+    PackedInt64Array out;
+
+    if (generator.is_null()) {
+        return out;
+    }
+
+    // Generate straight into the mesher scratch; the generator also fills the
+    // opaque mask from its column heights when it can.
+    const bool opaque_mask_ready = generator->generate_zxy(chunk_coord, g_voxels_zxy, g_opaque_mask);
+
+    mesh_scratch_zxy(out, opaque_mask_ready);
+    return out;
+}
+
+PackedInt64Array VoxelGreedyMesher::compute_normals(const PackedByteArray &material64_xyz) {
+    PackedInt64Array out;
+
+    if (material64_xyz.size() != VOX_COUNT) {
+        return out;
+    }
+
+    // Only occupancy matters: build the column masks straight from XYZ.
+    const uint8_t *src = material64_xyz.ptr();
+    BM_MEMSET(g_opaque_mask, 0, sizeof(g_opaque_mask));
+
+    for (int z = 0; z < VOX_SIZE; ++z) {
+        for (int y = 0; y < VOX_SIZE; ++y) {
+            const uint8_t *row = src + voxel_layout::index_xyz(0, y, z);
+            uint64_t *columns = g_opaque_mask + y * CS_P;
+            for (int x = 0; x < VOX_SIZE; ++x) {
+                columns[x] |= uint64_t(row[x] != 0) << z;
+            }
+        }
+    }
+
+    normals_from_opaque_mask(out);
+    return out;
+}
+
+PackedInt64Array VoxelGreedyMesher::compute_chunk_normals(const Ref<VoxelChunk> &chunk) {
+    PackedInt64Array out;
+
+    if (chunk.is_null()) {
+        return out;
+    }
+
+    chunk->unpack_materials_zxy(g_voxels_zxy);
+    voxel_layout::build_opaque_mask(g_voxels_zxy, g_opaque_mask);
+
+    normals_from_opaque_mask(out);
+    return out;
+}
+
+Vector3 VoxelGreedyMesher::decode_normal(int64_t packed) {
+    float n[3];
+    voxel_normals::decode_oct16(uint16_t(uint64_t(packed) >> 32), n);
+    return Vector3(n[0], n[1], n[2]);
+}
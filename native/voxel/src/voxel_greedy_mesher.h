@@ -4,6 +4,10 @@
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/variant/packed_byte_array.hpp>
 #include <godot_cpp/variant/packed_int64_array.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+#include "voxel_chunk.h"
+#include "voxel_terrain_generator.h"
 
 using namespace godot;
 
@@ -33,4 +37,39 @@ public:
     ///            type       |    h   |    w   |    z   |   y   |  x
     ///   - You already have C# vertex-pulling code: reuse it on these quads.
     PackedInt64Array mesh_chunk_quads(const PackedByteArray &material64_xyz);
+
+    /// Same output as mesh_chunk_quads, reading a VoxelChunk in place.
+    /// The chunk's palette storage is decoded straight into the ZXY scratch,
+    /// so no 64^3 PackedByteArray crosses the script boundary.
+    PackedInt64Array mesh_chunk(const Ref<VoxelChunk> &chunk);
+
+    /// Same output as mesh_chunk on a chunk stored with VoxelChunk::encode_rle()
+    /// (any format version): the runs are decoded straight into the ZXY
+    /// scratch and the opaque mask is filled run by run on the way, so no
+    /// chunk is created. Empty if the stream is not a whole chunk.
+    PackedInt64Array mesh_chunk_rle(const PackedByteArray &rle);
+
+    /// Same output as mesh_chunk on generator->generate_chunk(chunk_coord),
+    /// without creating the chunk: terrain is generated into the mesher's
+    /// ZXY scratch, the opaque mask comes from the column heights, and
+    /// nothing outlives the call. Use it for chunks nobody has edited; the
+    /// voxels are only stored once an edit materializes the chunk
+    /// (VoxelWorld::materialize_chunk).
+    PackedInt64Array mesh_generated(const Ref<VoxelTerrainGenerator> &generator, const Vector3i &chunk_coord);
+
+    /// Native VoxelMesh.ComputeNormals for a 64^3 XYZ chunk, surface voxels only.
+    ///
+    /// Returns:
+    ///   - PackedInt64Array, one entry per solid voxel with a non-zero
+    ///     occupancy gradient (all other voxels have a zero normal).
+    ///   - Bits: [47..32 | 17..0]
+    ///            oct16  | voxel index (x + y*64 + z*64*64)
+    ///   - Decode the normal with decode_normal().
+    PackedInt64Array compute_normals(const PackedByteArray &material64_xyz);
+
+    /// Same output as compute_normals, reading a VoxelChunk in place.
+    PackedInt64Array compute_chunk_normals(const Ref<VoxelChunk> &chunk);
+
+    /// Unit normal of a compute_normals() entry.
+    static Vector3 decode_normal(int64_t packed);
 };
@@ -0,0 +1,128 @@
+// voxel_heightmap_cache.cpp
+
+#include "voxel_heightmap_cache.h"
+
+// -----------------------------------------------------------------------------
+// LRU list
+// -----------------------------------------------------------------------------
+
+void VoxelHeightmapCache::unlink(uint32_t slot) {
+    Slot &s = slots[slot];
+    if (s.prev != NONE) {
+        slots[s.prev].next = s.next;
+    } else {
+        head = s.next;
+    }
+    if (s.next != NONE) {
+        slots[s.next].prev = s.prev;
+    } else {
+        tail = s.prev;
+    }
+    s.prev = NONE;
+    s.next = NONE;
+}
+
+void VoxelHeightmapCache::push_front(uint32_t slot) {
+    Slot &s = slots[slot];
+    s.prev = NONE;
+    s.next = head;
+    if (head != NONE) {
+        slots[head].prev = slot;
+    }
+    head = slot;
+    if (tail == NONE) {
+        tail = slot;
+    }
+}
+
+void VoxelHeightmapCache::clear_locked() {
+    index.clear();
+    slots.clear();
+    head = NONE;
+    tail = NONE;
+}
+
+// -----------------------------------------------------------------------------
+// Lookup & insert
+// -----------------------------------------------------------------------------
+
+VoxelHeightmapCache::MapPtr VoxelHeightmapCache::get(const Key &key) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    const uint32_t *slot = index.getptr(key);
+    if (slot == nullptr) {
+        ++misses;
+        return MapPtr();
+    }
+
+    ++hits;
+    if (*slot != head) {
+        unlink(*slot);
+        push_front(*slot);
+    }
+    return slots[*slot].map;
+}
+
+VoxelHeightmapCache::MapPtr VoxelHeightmapCache::insert(const Key &key, const MapPtr &map) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    const uint32_t *existing = index.getptr(key);
+    if (existing != nullptr) {
+        return slots[*existing].map;
+    }
+    if (capacity == 0) {
+        return map;
+    }
+
+    uint32_t slot;
+    if (slots.size() < capacity) {
+        slot = slots.size();
+        slots.push_back(Slot());
+    } else {
+        // Recycle the least recently used slot.
+        slot = tail;
+        unlink(slot);
+        index.erase(slots[slot].key);
+    }
+
+    slots[slot].key = key;
+    slots[slot].map = map;
+    push_front(slot);
+    index.insert(key, slot);
+    return map;
+}
+
+// -----------------------------------------------------------------------------
+// Housekeeping
+// -----------------------------------------------------------------------------
+
+void VoxelHeightmapCache::set_capacity(uint32_t max_entries) {
+    std::lock_guard<std::mutex> guard(lock);
+    capacity = max_entries;
+    clear_locked();
+}
+
+uint32_t VoxelHeightmapCache::get_capacity() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return capacity;
+}
+
+uint32_t VoxelHeightmapCache::get_size() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return slots.size();
+}
+
+void VoxelHeightmapCache::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    clear_locked();
+}
+
+uint64_t VoxelHeightmapCache::get_hits() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return hits;
+}
+
+uint64_t VoxelHeightmapCache::get_misses() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return misses;
+}
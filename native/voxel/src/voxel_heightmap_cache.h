@@ -0,0 +1,108 @@
+// voxel_heightmap_cache.h
+#pragma once
+
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+using namespace godot;
+
+/// Surface heights of one chunk column: what chunk generation derives from
+/// (x, z) alone, shared by every chunk stacked in that column.
+///
+/// Heights cover the 64x64 padded columns, indexed x*64 + z (the order the
+/// generator writes ZXY rows in).
+struct VoxelHeightmap {
+    static constexpr int SIZE         = 64;
+    static constexpr int COLUMN_COUNT = SIZE * SIZE;
+
+    int32_t heights[COLUMN_COUNT];    // world y of the top solid voxel
+
+    int32_t min_height = 0;
+    int32_t max_height = 0;
+};
+
+/// Thread-safe LRU cache of VoxelHeightmaps keyed by (cx, cz, seed).
+///
+/// Entries are immutable and handed out as shared_ptr, so a reader keeps
+/// its heightmap alive even if the cache evicts it meanwhile. Lookups and
+/// inserts take one short mutex; building a missing map happens outside it,
+/// so two threads missing the same key at once may both build it and the
+/// first insert wins.
+class VoxelHeightmapCache {
+public:
+    struct Key {
+        int32_t  cx   = 0;
+        int32_t  cz   = 0;
+        uint32_t seed = 0;
+
+        bool operator==(const Key &other) const {
+            return cx == other.cx && cz == other.cz && seed == other.seed;
+        }
+    };
+
+    struct KeyHasher {
+        static _FORCE_INLINE_ uint32_t hash(const Key &p_key) {
+            const uint64_t xz = uint64_t(uint32_t(p_key.cx)) | (uint64_t(uint32_t(p_key.cz)) << 32);
+            return uint32_t(((xz ^ (uint64_t(p_key.seed) * 0xC2B2AE3D27D4EB4Full)) * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+    };
+
+    typedef std::shared_ptr<const VoxelHeightmap> MapPtr;
+
+    explicit VoxelHeightmapCache(uint32_t max_entries = 256) : capacity(max_entries) {}
+
+    /// Resident heightmap for `key` (marked most recently used), or null.
+    MapPtr get(const Key &key);
+
+    /// Insert `map` unless `key` is already resident; returns the resident map.
+    MapPtr insert(const Key &key, const MapPtr &map);
+
+    /// get(), or build with `fn(VoxelHeightmap &)` and insert on a miss.
+    template <typename F>
+    MapPtr get_or_build(const Key &key, F &&fn) {
+        MapPtr map = get(key);
+        if (map) {
+            return map;
+        }
+        std::shared_ptr<VoxelHeightmap> built = std::make_shared<VoxelHeightmap>();
+        fn(*built);
+        return insert(key, built);
+    }
+
+    /// Changing the capacity drops every entry.
+    void set_capacity(uint32_t max_entries);
+    uint32_t get_capacity() const;
+
+    uint32_t get_size() const;
+    void clear();
+
+    uint64_t get_hits() const;
+    uint64_t get_misses() const;
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Slot {
+        Key      key;
+        MapPtr   map;
+        uint32_t prev = NONE;   // towards most recently used
+        uint32_t next = NONE;   // towards least recently used
+    };
+
+    void unlink(uint32_t slot);
+    void push_front(uint32_t slot);
+    void clear_locked();
+
+    mutable std::mutex                      lock;
+    HashMap<Key, uint32_t, KeyHasher>       index;
+    LocalVector<Slot>                       slots;
+    uint32_t                                head     = NONE;   // most recently used
+    uint32_t                                tail     = NONE;   // least recently used
+    uint32_t                                capacity = 256;
+    uint64_t                                hits     = 0;
+    uint64_t                                misses   = 0;
+};
@@ -0,0 +1,57 @@
+// voxel_layout.h
+#pragma once
+
+#include <stdint.h>
+
+/// Conversions between the caller layout (XYZ, x fastest) and the meshers'
+/// native layout (ZXY, z fastest) of a padded 64^3 chunk, and the opaque
+/// mask both meshers consume.
+namespace voxel_layout {
+
+static constexpr int SIZE  = 64;
+static constexpr int SIZE2 = SIZE * SIZE;
+
+// Caller layout XYZ: idx = x + y*64 + z*64*64
+static inline int index_xyz(int x, int y, int z) {
+    return x + y * SIZE + z * SIZE2;
+}
+
+// Mesher layout ZXY: z is fastest axis.
+static inline int index_zxy(int x, int y, int z) {
+    return z + x * SIZE + y * SIZE2;
+}
+
+static inline void xyz_to_zxy(const uint8_t *src_xyz, uint8_t *dst_zxy) {
+    for (int z = 0; z < SIZE; ++z) {
+        for (int x = 0; x < SIZE; ++x) {
+            for (int y = 0; y < SIZE; ++y) {
+                dst_zxy[index_zxy(x, y, z)] = src_xyz[index_xyz(x, y, z)];
+            }
+        }
+    }
+}
+
+// One 64-bit column per (x, y), indexed y*64 + x, with bit z set when voxel
+// (x, y, z) is solid. In ZXY order that column is the 64 bytes starting at
+// x*64 + y*64*64, so column_index == base_index / 64.
+static inline void build_opaque_mask(const uint8_t *voxels_zxy, uint64_t *opaque_mask) {
+    for (int y = 0; y < SIZE; ++y) {
+        for (int x = 0; x < SIZE; ++x) {
+            const int column_index = y * SIZE + x;
+            const int base_index   = x * SIZE + y * SIZE2; // z runs fastest
+
+            uint64_t bits = 0;
+
+            for (int z = 0; z < SIZE; ++z) {
+                const uint8_t type = voxels_zxy[base_index + z];
+                if (type != 0) {
+                    bits |= (1ull << z);
+                }
+            }
+
+            opaque_mask[column_index] = bits;
+        }
+    }
+}
+
+} // namespace voxel_layout
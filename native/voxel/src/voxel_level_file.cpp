@@ -0,0 +1,115 @@
+// voxel_level_file.cpp
+
+#include "voxel_level_file.h"
+
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+#include <string.h>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelLevelFile::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("load", "path"), &VoxelLevelFile::load);
+    ClassDB::bind_method(D_METHOD("is_loaded"), &VoxelLevelFile::is_loaded);
+
+    ClassDB::bind_method(D_METHOD("get_size"), &VoxelLevelFile::get_size);
+    ClassDB::bind_method(D_METHOD("get_chunk_count"), &VoxelLevelFile::get_chunk_count);
+
+    ClassDB::bind_method(D_METHOD("has_chunk", "key"), &VoxelLevelFile::has_chunk);
+    ClassDB::bind_method(D_METHOD("get_chunk_rle", "key"), &VoxelLevelFile::get_chunk_rle);
+    ClassDB::bind_method(D_METHOD("load_chunk", "key"), &VoxelLevelFile::load_chunk);
+    ClassDB::bind_method(D_METHOD("get_keys"), &VoxelLevelFile::get_keys);
+}
+
+// -----------------------------------------------------------------------------
+// Loading
+// -----------------------------------------------------------------------------
+
+bool VoxelLevelFile::load(const String &path) {
+    const String global_path = ProjectSettings::get_singleton()->globalize_path(path);
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    loaded = level.loadFromFile(global_path.utf8().get_data());
+    return loaded;
+}
+
+bool VoxelLevelFile::is_loaded() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return loaded;
+}
+
+int VoxelLevelFile::get_size() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return loaded ? (int)level.getSize() : 0;
+}
+
+int VoxelLevelFile::get_chunk_count() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return loaded ? (int)level.getChunkCount() : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Chunks
+// -----------------------------------------------------------------------------
+
+bool VoxelLevelFile::has_chunk(int64_t key) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return loaded && level.findChunk((uint32_t)key) >= 0;
+}
+
+PackedByteArray VoxelLevelFile::get_chunk_rle(int64_t key) const {
+    PackedByteArray out;
+
+    std::shared_lock<std::shared_mutex> guard(lock);
+    if (!loaded) {
+        return out;
+    }
+
+    const ChunkSpan span = level.getChunkByKey((uint32_t)key);
+    if (span.data == nullptr) {
+        return out;
+    }
+    out.resize(span.size);
+    memcpy(out.ptrw(), span.data, span.size);
+    return out;
+}
+
+Ref<VoxelChunk> VoxelLevelFile::load_chunk(int64_t key) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    if (!loaded) {
+        return Ref<VoxelChunk>();
+    }
+
+    const ChunkSpan span = level.getChunkByKey((uint32_t)key);
+    if (span.data == nullptr) {
+        return Ref<VoxelChunk>();
+    }
+
+    Ref<VoxelChunk> chunk;
+    chunk.instantiate();
+    if (!chunk->decode_rle_data(span.data, span.size)) {
+        return Ref<VoxelChunk>();
+    }
+    return chunk;
+}
+
+PackedInt64Array VoxelLevelFile::get_keys() const {
+    PackedInt64Array out;
+
+    std::shared_lock<std::shared_mutex> guard(lock);
+    if (!loaded) {
+        return out;
+    }
+
+    for (uint32_t i = 0; i < level.getTableLength(); ++i) {
+        if (level.getChunkData(i).data != nullptr && level.findChunk(level.getTableEntry(i).key) == (int32_t)i) {
+            out.push_back(level.getTableEntry(i).key);
+        }
+    }
+    return out;
+}
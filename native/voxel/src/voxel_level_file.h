@@ -0,0 +1,57 @@
+// voxel_level_file.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_int64_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include <cgerikj_level_file.h>
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "voxel_chunk.h"
+
+using namespace godot;
+
+/// Read access to cgerikj level files (LevelFile) from scripts.
+///
+/// The file is memory-mapped and a hash index over the chunk table is built
+/// on load, so looking a chunk up by key is O(1) whatever the world size,
+/// and load_chunk() decodes straight from the mapping into a VoxelChunk.
+/// Any number of threads may read chunks while no load() is running.
+class VoxelLevelFile : public RefCounted {
+    GDCLASS(VoxelLevelFile, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    VoxelLevelFile() = default;
+    ~VoxelLevelFile() = default;
+
+    /// Map the level at `path` (res:// and user:// paths are accepted).
+    bool load(const String &path);
+    bool is_loaded() const;
+
+    /// World size in chunks along x and z.
+    int get_size() const;
+    int get_chunk_count() const;
+
+    bool has_chunk(int64_t key) const;
+
+    /// Copy of the chunk's RLE data; empty if there is no chunk for `key`.
+    PackedByteArray get_chunk_rle(int64_t key) const;
+
+    /// The chunk stored under `key`, decoded; null if missing or corrupt.
+    Ref<VoxelChunk> load_chunk(int64_t key) const;
+
+    /// Keys of all stored chunks, in table order.
+    PackedInt64Array get_keys() const;
+
+private:
+    mutable std::shared_mutex lock;
+    LevelFile                 level;
+    bool                      loaded = false;
+};
@@ -0,0 +1,405 @@
+// voxel_noise.h
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VOXEL_NOISE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/// Deterministic gradient noise for world generation and sculpting.
+///
+/// Everything here is a pure function of (position, seed): no tables, no
+/// global state, so any thread can evaluate any chunk and get the same bits.
+/// Output is roughly in [-1, 1].
+///
+/// The 2D terrain path evaluates four columns at once with SSE2 when the
+/// target has it. Each build uses one path for every column, so results
+/// never depend on which thread or which lane computed them. Both paths do
+/// the same float operations in the same order and give the same bits as
+/// long as nothing is contracted into FMA: build with -ffp-contract=off
+/// (SConstruct does). VoxelTerrainGenerator::get_settings_hash() probes the
+/// result, so a build that differs anyway refuses other builds' diffs.
+namespace voxel_noise {
+
+// Scales 2D gradient noise (gradients (+/-1, +/-2)) to roughly [-1, 1].
+static constexpr float PERLIN2_SCALE = 0.64f;
+
+static inline uint32_t mix32(uint32_t h) {
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return h;
+}
+
+static inline uint32_t hash2(int32_t x, int32_t y, uint32_t seed) {
+    return mix32(seed ^ (uint32_t(x) * 0x8DA6B343u) ^ (uint32_t(y) * 0xD8163841u));
+}
+
+static inline uint32_t hash3(int32_t x, int32_t y, int32_t z, uint32_t seed) {
+    uint32_t h = seed;
+    h ^= uint32_t(x) * 0x8DA6B343u;
+    h ^= uint32_t(y) * 0xD8163841u;
+    h ^= uint32_t(z) * 0xCB1AB31Fu;
+    return mix32(h);
+}
+
+// Quintic fade 6t^5 - 15t^4 + 10t^3.
+static inline float fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static inline float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+// Dot product with one of the 12 cube-edge gradients picked by `h`.
+static inline float grad3(uint32_t h, float x, float y, float z) {
+    const uint32_t g = h & 15;
+    const float u = g < 8 ? x : y;
+    const float v = g < 4 ? y : (g == 12 || g == 14 ? x : z);
+    return ((g & 1) ? -u : u) + ((g & 2) ? -v : v);
+}
+
+/// Classic 3D gradient (Perlin) noise.
+static inline float perlin3(float x, float y, float z, uint32_t seed) {
+    const float fx = floorf(x), fy = floorf(y), fz = floorf(z);
+    const int32_t ix = (int32_t)fx, iy = (int32_t)fy, iz = (int32_t)fz;
+    const float dx = x - fx, dy = y - fy, dz = z - fz;
+
+    const float n000 = grad3(hash3(ix,     iy,     iz,     seed), dx,        dy,        dz);
+    const float n100 = grad3(hash3(ix + 1, iy,     iz,     seed), dx - 1.0f, dy,        dz);
+    const float n010 = grad3(hash3(ix,     iy + 1, iz,     seed), dx,        dy - 1.0f, dz);
+    const float n110 = grad3(hash3(ix + 1, iy + 1, iz,     seed), dx - 1.0f, dy - 1.0f, dz);
+    const float n001 = grad3(hash3(ix,     iy,     iz + 1, seed), dx,        dy,        dz - 1.0f);
+    const float n101 = grad3(hash3(ix + 1, iy,     iz + 1, seed), dx - 1.0f, dy,        dz - 1.0f);
+    const float n011 = grad3(hash3(ix,     iy + 1, iz + 1, seed), dx,        dy - 1.0f, dz - 1.0f);
+    const float n111 = grad3(hash3(ix + 1, iy + 1, iz + 1, seed), dx - 1.0f, dy - 1.0f, dz - 1.0f);
+
+    const float u = fade(dx), v = fade(dy), w = fade(dz);
+
+    const float x00 = lerp(n000, n100, u);
+    const float x10 = lerp(n010, n110, u);
+    const float x01 = lerp(n001, n101, u);
+    const float x11 = lerp(n011, n111, u);
+
+    return lerp(lerp(x00, x10, v), lerp(x01, x11, v), w);
+}
+
+// -----------------------------------------------------------------------------
+// 2D gradient noise and fBm (terrain height fields)
+// -----------------------------------------------------------------------------
+
+// Dot product with one of 8 gradients (+/-1, +/-2) / (+/-2, +/-1) picked by `h`.
+static inline float grad2(uint32_t h, float x, float y) {
+    const uint32_t g = h & 7;
+    const float u = g < 4 ? x : y;
+    const float v = g < 4 ? y : x;
+    return ((g & 1) ? -u : u) + ((g & 2) ? -(v + v) : (v + v));
+}
+
+static inline float perlin2(float x, float y, uint32_t seed) {
+    const float fx = floorf(x), fy = floorf(y);
+    const int32_t ix = (int32_t)fx, iy = (int32_t)fy;
+    const float dx = x - fx, dy = y - fy;
+
+    const float n00 = grad2(hash2(ix,     iy,     seed), dx,        dy);
+    const float n10 = grad2(hash2(ix + 1, iy,     seed), dx - 1.0f, dy);
+    const float n01 = grad2(hash2(ix,     iy + 1, seed), dx,        dy - 1.0f);
+    const float n11 = grad2(hash2(ix + 1, iy + 1, seed), dx - 1.0f, dy - 1.0f);
+
+    const float u = fade(dx), v = fade(dy);
+    return lerp(lerp(n00, n10, u), lerp(n01, n11, u), v) * PERLIN2_SCALE;
+}
+
+/// Fractal Brownian motion: `octaves` layers of perlin2, each at
+/// `lacunarity` times the frequency and `gain` times the amplitude of the
+/// previous one, with seed + octave. Normalised by the summed amplitudes.
+static inline float fbm2(float x, float y, uint32_t seed, int octaves, float lacunarity = 2.0f, float gain = 0.5f) {
+    float sum = 0.0f;
+    float amp = 1.0f;
+    float bound = 0.0f;
+    for (int o = 0; o < octaves; ++o) {
+        sum += perlin2(x, y, seed + uint32_t(o)) * amp;
+        bound += amp;
+        x *= lacunarity;
+        y *= lacunarity;
+        amp *= gain;
+    }
+    return bound > 0.0f ? sum / bound : 0.0f;
+}
+
+#ifdef VOXEL_NOISE_SSE2
+
+// 32-bit lane multiply (SSE2 only has the 32x32->64 even-lane form).
+static inline __m128i mullo32_sse2(__m128i a, __m128i b) {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i mix32_sse2(__m128i h) {
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    h = mullo32_sse2(h, _mm_set1_epi32((int)0x2C1B3C6Du));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 12));
+    h = mullo32_sse2(h, _mm_set1_epi32((int)0x297A2D39u));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    return h;
+}
+
+static inline __m128 grad2_sse2(__m128i h, __m128 x, __m128 y) {
+    const __m128i g   = _mm_and_si128(h, _mm_set1_epi32(7));
+    const __m128  sel = _mm_castsi128_ps(_mm_cmplt_epi32(g, _mm_set1_epi32(4)));
+
+    __m128 u = _mm_or_ps(_mm_and_ps(sel, x), _mm_andnot_ps(sel, y));
+    __m128 v = _mm_or_ps(_mm_and_ps(sel, y), _mm_andnot_ps(sel, x));
+
+    // Bit 0 flips the sign of u, bit 1 the sign of v.
+    u = _mm_xor_ps(u, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31)));
+    v = _mm_xor_ps(v, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30)));
+    return _mm_add_ps(u, _mm_add_ps(v, v));
+}
+
+static inline __m128 fade_sse2(__m128 t) {
+    const __m128 t3    = _mm_mul_ps(_mm_mul_ps(t, t), t);
+    const __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(t3, inner);
+}
+
+static inline __m128 lerp_sse2(__m128 a, __m128 b, __m128 t) {
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+static inline __m128 perlin2_sse2(__m128 x, __m128 y, uint32_t seed) {
+    // floor(): truncate, then step down where truncation rounded up.
+    __m128i ix = _mm_cvttps_epi32(x);
+    __m128i iy = _mm_cvttps_epi32(y);
+    ix = _mm_add_epi32(ix, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(ix), x)));
+    iy = _mm_add_epi32(iy, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(iy), y)));
+
+    const __m128 dx = _mm_sub_ps(x, _mm_cvtepi32_ps(ix));
+    const __m128 dy = _mm_sub_ps(y, _mm_cvtepi32_ps(iy));
+
+    // (i + 1) * P == i * P + P modulo 2^32, so each axis costs one multiply.
+    const __m128i px  = _mm_set1_epi32((int)0x8DA6B343u);
+    const __m128i py  = _mm_set1_epi32((int)0xD8163841u);
+    const __m128i hx0 = mullo32_sse2(ix, px);
+    const __m128i hx1 = _mm_add_epi32(hx0, px);
+    const __m128i hy  = mullo32_sse2(iy, py);
+    const __m128i s   = _mm_set1_epi32((int)seed);
+    const __m128i hy0 = _mm_xor_si128(hy, s);
+    const __m128i hy1 = _mm_xor_si128(_mm_add_epi32(hy, py), s);
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 dx1 = _mm_sub_ps(dx, one);
+    const __m128 dy1 = _mm_sub_ps(dy, one);
+
+    const __m128 n00 = grad2_sse2(mix32_sse2(_mm_xor_si128(hx0, hy0)), dx,  dy);
+    const __m128 n10 = grad2_sse2(mix32_sse2(_mm_xor_si128(hx1, hy0)), dx1, dy);
+    const __m128 n01 = grad2_sse2(mix32_sse2(_mm_xor_si128(hx0, hy1)), dx,  dy1);
+    const __m128 n11 = grad2_sse2(mix32_sse2(_mm_xor_si128(hx1, hy1)), dx1, dy1);
+
+    const __m128 u = fade_sse2(dx);
+    const __m128 v = fade_sse2(dy);
+    return _mm_mul_ps(lerp_sse2(lerp_sse2(n00, n10, u), lerp_sse2(n01, n11, u), v), _mm_set1_ps(PERLIN2_SCALE));
+}
+
+#endif // VOXEL_NOISE_SSE2
+
+/// fbm2() for four points at once: out[i] = fbm2(x[i], y[i], ...).
+static inline void fbm2_x4(const float *x, const float *y, uint32_t seed, int octaves, float lacunarity, float gain, float *out) {
+#ifdef VOXEL_NOISE_SSE2
+    __m128 px = _mm_loadu_ps(x);
+    __m128 py = _mm_loadu_ps(y);
+    __m128 sum = _mm_setzero_ps();
+    const __m128 lac = _mm_set1_ps(lacunarity);
+    float amp = 1.0f;
+    float bound = 0.0f;
+    for (int o = 0; o < octaves; ++o) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(perlin2_sse2(px, py, seed + uint32_t(o)), _mm_set1_ps(amp)));
+        bound += amp;
+        px = _mm_mul_ps(px, lac);
+        py = _mm_mul_ps(py, lac);
+        amp *= gain;
+    }
+    _mm_storeu_ps(out, bound > 0.0f ? _mm_div_ps(sum, _mm_set1_ps(bound)) : _mm_setzero_ps());
+#else
+    for (int i = 0; i < 4; ++i) {
+        out[i] = fbm2(x[i], y[i], seed, octaves, lacunarity, gain);
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// 3D fBm and ridged noise (caves)
+// -----------------------------------------------------------------------------
+
+static inline float fbm3(float x, float y, float z, uint32_t seed, int octaves, float lacunarity = 2.0f, float gain = 0.5f) {
+    float sum = 0.0f;
+    float amp = 1.0f;
+    float bound = 0.0f;
+    for (int o = 0; o < octaves; ++o) {
+        sum += perlin3(x, y, z, seed + uint32_t(o)) * amp;
+        bound += amp;
+        x *= lacunarity;
+        y *= lacunarity;
+        z *= lacunarity;
+        amp *= gain;
+    }
+    return bound > 0.0f ? sum / bound : 0.0f;
+}
+
+/// Ridged multifractal: octaves of 1 - |perlin3|, in [0, 1]. Values near 1
+/// trace the noise's zero surfaces, which makes long winding tunnels.
+static inline float ridged3(float x, float y, float z, uint32_t seed, int octaves, float lacunarity = 2.0f, float gain = 0.5f) {
+    float sum = 0.0f;
+    float amp = 1.0f;
+    float bound = 0.0f;
+    for (int o = 0; o < octaves; ++o) {
+        sum += (1.0f - fabsf(perlin3(x, y, z, seed + uint32_t(o)))) * amp;
+        bound += amp;
+        x *= lacunarity;
+        y *= lacunarity;
+        z *= lacunarity;
+        amp *= gain;
+    }
+    return bound > 0.0f ? sum / bound : 0.0f;
+}
+
+#ifdef VOXEL_NOISE_SSE2
+
+static inline __m128 grad3_sse2(__m128i h, __m128 x, __m128 y, __m128 z) {
+    const __m128i g = _mm_and_si128(h, _mm_set1_epi32(15));
+
+    const __m128 sel_u = _mm_castsi128_ps(_mm_cmplt_epi32(g, _mm_set1_epi32(8)));
+    const __m128 sel_y = _mm_castsi128_ps(_mm_cmplt_epi32(g, _mm_set1_epi32(4)));
+    const __m128 sel_x = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(g, _mm_set1_epi32(12)),
+                                                       _mm_cmpeq_epi32(g, _mm_set1_epi32(14))));
+
+    __m128 u = _mm_or_ps(_mm_and_ps(sel_u, x), _mm_andnot_ps(sel_u, y));
+    __m128 v = _mm_or_ps(_mm_and_ps(sel_x, x), _mm_andnot_ps(sel_x, z));
+    v = _mm_or_ps(_mm_and_ps(sel_y, y), _mm_andnot_ps(sel_y, v));
+
+    u = _mm_xor_ps(u, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31)));
+    v = _mm_xor_ps(v, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30)));
+    return _mm_add_ps(u, v);
+}
+
+static inline __m128i floor_epi32_sse2(__m128 v) {
+    const __m128i i = _mm_cvttps_epi32(v);
+    return _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), v)));
+}
+
+static inline __m128 perlin3_sse2(__m128 x, __m128 y, __m128 z, uint32_t seed) {
+    const __m128i ix = floor_epi32_sse2(x);
+    const __m128i iy = floor_epi32_sse2(y);
+    const __m128i iz = floor_epi32_sse2(z);
+
+    const __m128 dx = _mm_sub_ps(x, _mm_cvtepi32_ps(ix));
+    const __m128 dy = _mm_sub_ps(y, _mm_cvtepi32_ps(iy));
+    const __m128 dz = _mm_sub_ps(z, _mm_cvtepi32_ps(iz));
+
+    const __m128i px  = _mm_set1_epi32((int)0x8DA6B343u);
+    const __m128i py  = _mm_set1_epi32((int)0xD8163841u);
+    const __m128i pz  = _mm_set1_epi32((int)0xCB1AB31Fu);
+    const __m128i hx0 = _mm_xor_si128(mullo32_sse2(ix, px), _mm_set1_epi32((int)seed));
+    const __m128i hx1 = _mm_xor_si128(_mm_add_epi32(mullo32_sse2(ix, px), px), _mm_set1_epi32((int)seed));
+    const __m128i hy0 = mullo32_sse2(iy, py);
+    const __m128i hy1 = _mm_add_epi32(hy0, py);
+    const __m128i hz0 = mullo32_sse2(iz, pz);
+    const __m128i hz1 = _mm_add_epi32(hz0, pz);
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 dx1 = _mm_sub_ps(dx, one);
+    const __m128 dy1 = _mm_sub_ps(dy, one);
+    const __m128 dz1 = _mm_sub_ps(dz, one);
+
+    const __m128i h00 = _mm_xor_si128(hy0, hz0);
+    const __m128i h10 = _mm_xor_si128(hy1, hz0);
+    const __m128i h01 = _mm_xor_si128(hy0, hz1);
+    const __m128i h11 = _mm_xor_si128(hy1, hz1);
+
+    const __m128 n000 = grad3_sse2(mix32_sse2(_mm_xor_si128(hx0, h00)), dx,  dy,  dz);
+    const __m128 n100 = grad3_sse2(mix32_sse2(_mm_xor_si128(hx1, h00)), dx1, dy,  dz);
+    const __m128 n010 = grad3_sse2(mix32_sse2(_mm_xor_si128(hx0, h10)), dx,  dy1, dz);
+    const __m128 n110 = grad3_sse2(mix32_sse2(_mm_xor_si128(hx1, h10)), dx1, dy1, dz);
+    const __m128 n001 = grad3_sse2(mix32_sse2(_mm_xor_si128(hx0, h01)), dx,  dy,  dz1);
+    const __m128 n101 = grad3_sse2(mix32_sse2(_mm_xor_si128(hx1, h01)), dx1, dy,  dz1);
+    const __m128 n011 = grad3_sse2(mix32_sse2(_mm_xor_si128(hx0, h11)), dx,  dy1, dz1);
+    const __m128 n111 = grad3_sse2(mix32_sse2(_mm_xor_si128(hx1, h11)), dx1, dy1, dz1);
+
+    const __m128 u = fade_sse2(dx);
+    const __m128 v = fade_sse2(dy);
+    const __m128 w = fade_sse2(dz);
+
+    const __m128 x00 = lerp_sse2(n000, n100, u);
+    const __m128 x10 = lerp_sse2(n010, n110, u);
+    const __m128 x01 = lerp_sse2(n001, n101, u);
+    const __m128 x11 = lerp_sse2(n011, n111, u);
+
+    return lerp_sse2(lerp_sse2(x00, x10, v), lerp_sse2(x01, x11, v), w);
+}
+
+#endif // VOXEL_NOISE_SSE2
+
+/// fbm3() for four points at once.
+static inline void fbm3_x4(const float *x, const float *y, const float *z, uint32_t seed, int octaves, float lacunarity, float gain, float *out) {
+#ifdef VOXEL_NOISE_SSE2
+    __m128 px = _mm_loadu_ps(x);
+    __m128 py = _mm_loadu_ps(y);
+    __m128 pz = _mm_loadu_ps(z);
+    __m128 sum = _mm_setzero_ps();
+    const __m128 lac = _mm_set1_ps(lacunarity);
+    float amp = 1.0f;
+    float bound = 0.0f;
+    for (int o = 0; o < octaves; ++o) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(perlin3_sse2(px, py, pz, seed + uint32_t(o)), _mm_set1_ps(amp)));
+        bound += amp;
+        px = _mm_mul_ps(px, lac);
+        py = _mm_mul_ps(py, lac);
+        pz = _mm_mul_ps(pz, lac);
+        amp *= gain;
+    }
+    _mm_storeu_ps(out, bound > 0.0f ? _mm_div_ps(sum, _mm_set1_ps(bound)) : _mm_setzero_ps());
+#else
+    for (int i = 0; i < 4; ++i) {
+        out[i] = fbm3(x[i], y[i], z[i], seed, octaves, lacunarity, gain);
+    }
+#endif
+}
+
+/// ridged3() for four points at once.
+static inline void ridged3_x4(const float *x, const float *y, const float *z, uint32_t seed, int octaves, float lacunarity, float gain, float *out) {
+#ifdef VOXEL_NOISE_SSE2
+    __m128 px = _mm_loadu_ps(x);
+    __m128 py = _mm_loadu_ps(y);
+    __m128 pz = _mm_loadu_ps(z);
+    __m128 sum = _mm_setzero_ps();
+    const __m128 lac  = _mm_set1_ps(lacunarity);
+    const __m128 one  = _mm_set1_ps(1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    float amp = 1.0f;
+    float bound = 0.0f;
+    for (int o = 0; o < octaves; ++o) {
+        const __m128 n = _mm_andnot_ps(sign, perlin3_sse2(px, py, pz, seed + uint32_t(o)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_sub_ps(one, n), _mm_set1_ps(amp)));
+        bound += amp;
+        px = _mm_mul_ps(px, lac);
+        py = _mm_mul_ps(py, lac);
+        pz = _mm_mul_ps(pz, lac);
+        amp *= gain;
+    }
+    _mm_storeu_ps(out, bound > 0.0f ? _mm_div_ps(sum, _mm_set1_ps(bound)) : _mm_setzero_ps());
+#else
+    for (int i = 0; i < 4; ++i) {
+        out[i] = ridged3(x[i], y[i], z[i], seed, octaves, lacunarity, gain);
+    }
+#endif
+}
+
+} // namespace voxel_noise
@@ -0,0 +1,158 @@
+// voxel_normals.cpp
+
+#include "voxel_normals.h"
+#include "voxel_bits.h"
+
+#include <math.h>
+
+namespace voxel_normals {
+
+// -----------------------------------------------------------------------------
+// Octahedral encoding
+// -----------------------------------------------------------------------------
+
+static inline float sign_not_zero(float v) {
+    return v < 0.0f ? -1.0f : 1.0f;
+}
+
+static inline uint8_t to_snorm8(float v) {
+    v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+    return (uint8_t)(int8_t)lrintf(v * 127.0f);
+}
+
+static inline float from_snorm8(uint8_t v) {
+    const float f = (int8_t)v / 127.0f;
+    return f < -1.0f ? -1.0f : f;
+}
+
+uint16_t encode_oct16(float x, float y, float z) {
+    const float l1 = fabsf(x) + fabsf(y) + fabsf(z);
+    if (l1 <= 0.0f) {
+        return 0;
+    }
+    float u = x / l1;
+    float v = y / l1;
+    if (z < 0.0f) {
+        const float fu = (1.0f - fabsf(v)) * sign_not_zero(u);
+        const float fv = (1.0f - fabsf(u)) * sign_not_zero(v);
+        u = fu;
+        v = fv;
+    }
+    return uint16_t(to_snorm8(u)) | uint16_t(uint16_t(to_snorm8(v)) << 8);
+}
+
+void decode_oct16(uint16_t oct, float out[3]) {
+    float x = from_snorm8(uint8_t(oct & 0xFF));
+    float y = from_snorm8(uint8_t(oct >> 8));
+    const float z = 1.0f - fabsf(x) - fabsf(y);
+    if (z < 0.0f) {
+        const float fx = (1.0f - fabsf(y)) * sign_not_zero(x);
+        const float fy = (1.0f - fabsf(x)) * sign_not_zero(y);
+        x = fx;
+        y = fy;
+    }
+    const float len = sqrtf(x * x + y * y + z * z);
+    out[0] = x / len;
+    out[1] = y / len;
+    out[2] = z / len;
+}
+
+// Direction code (nx+1) + (ny+1)*3 + (nz+1)*9 -> oct16, built once.
+struct DirectionTable {
+    uint16_t oct[27];
+
+    DirectionTable() {
+        for (int code = 0; code < 27; ++code) {
+            const int nx = code % 3 - 1;
+            const int ny = (code / 3) % 3 - 1;
+            const int nz = code / 9 - 1;
+            oct[code] = encode_oct16((float)nx, (float)ny, (float)nz);
+        }
+    }
+};
+
+static const DirectionTable g_directions;
+
+// -----------------------------------------------------------------------------
+// Surface masks
+// -----------------------------------------------------------------------------
+
+// Per-column masks of voxels whose normal points along +axis / -axis.
+struct ColumnNormals {
+    uint64_t pos[3];
+    uint64_t neg[3];
+    uint64_t surface;
+};
+
+static inline void column_normals(const uint64_t *opaque_mask, int x, int y, ColumnNormals &out) {
+    const uint64_t c = opaque_mask[y * SIZE + x];
+    if (c == 0) {
+        out.surface = 0;
+        return;
+    }
+
+    // Occupancy of the neighbour in each direction, aligned to this column's bits.
+    const uint64_t xp = x + 1 < SIZE ? opaque_mask[y * SIZE + x + 1] : 0;
+    const uint64_t xm = x > 0        ? opaque_mask[y * SIZE + x - 1] : 0;
+    const uint64_t yp = y + 1 < SIZE ? opaque_mask[(y + 1) * SIZE + x] : 0;
+    const uint64_t ym = y > 0        ? opaque_mask[(y - 1) * SIZE + x] : 0;
+    const uint64_t zp = c >> 1;
+    const uint64_t zm = c << 1;
+
+    // The normal points away from the solid side: +axis when only the
+    // neighbour behind is solid.
+    out.pos[0] = c & xm & ~xp;
+    out.neg[0] = c & xp & ~xm;
+    out.pos[1] = c & ym & ~yp;
+    out.neg[1] = c & yp & ~ym;
+    out.pos[2] = c & zm & ~zp;
+    out.neg[2] = c & zp & ~zm;
+
+    // Solid voxels whose gradient is non-zero on some axis.
+    out.surface = c & ((xp ^ xm) | (yp ^ ym) | (zp ^ zm));
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+int count_surface_voxels(const uint64_t *opaque_mask) {
+    int count = 0;
+    ColumnNormals n;
+    for (int y = 0; y < SIZE; ++y) {
+        for (int x = 0; x < SIZE; ++x) {
+            column_normals(opaque_mask, x, y, n);
+            if (n.surface) {
+                count += voxel_bits::popcount64(n.surface);
+            }
+        }
+    }
+    return count;
+}
+
+void compute_surface_normals(const uint64_t *opaque_mask, int64_t *out) {
+    int dst = 0;
+    ColumnNormals n;
+
+    for (int y = 0; y < SIZE; ++y) {
+        for (int x = 0; x < SIZE; ++x) {
+            column_normals(opaque_mask, x, y, n);
+
+            uint64_t bits = n.surface;
+            while (bits) {
+                const int z = voxel_bits::ctz64(bits);
+                bits &= bits - 1;
+
+                const int code = 13
+                    + (int((n.pos[0] >> z) & 1) - int((n.neg[0] >> z) & 1))
+                    + (int((n.pos[1] >> z) & 1) - int((n.neg[1] >> z) & 1)) * 3
+                    + (int((n.pos[2] >> z) & 1) - int((n.neg[2] >> z) & 1)) * 9;
+
+                const int64_t index = x + y * SIZE + z * SIZE * SIZE;
+                out[dst++] = index | (int64_t(g_directions.oct[code]) << 32);
+            }
+        }
+    }
+}
+
+} // namespace voxel_normals
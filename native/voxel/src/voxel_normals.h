@@ -0,0 +1,33 @@
+// voxel_normals.h
+#pragma once
+
+#include <stdint.h>
+
+/// Occupancy-gradient normals for solid voxels, computed from the mesher's
+/// opaque mask (one word per (x, y), indexed y*64 + x, bit z = solid).
+///
+/// Port of VoxelMesh.ComputeNormals: the normal of a solid voxel is
+/// -(occ(p + axis) - occ(p - axis)) per axis, normalized, with everything
+/// outside the 64^3 chunk counting as empty. Each component is -1, 0 or +1,
+/// so there are only 26 possible directions; their octahedral encodings are
+/// precomputed. Neighbour occupancy for a whole column of 64 voxels is a
+/// handful of shifts and ANDs on the neighbouring words, and only voxels
+/// with a non-zero gradient (the surface) produce output.
+///
+/// Output entries are 64-bit: bits 0..17 hold the voxel index in the
+/// caller's XYZ layout (x + y*64 + z*64*64), bits 32..47 the oct16 normal.
+namespace voxel_normals {
+
+static constexpr int SIZE = 64;
+
+/// Number of voxels compute_surface_normals() will write.
+int count_surface_voxels(const uint64_t *opaque_mask);
+
+/// Write one packed entry per surface voxel, in (y, x, z) order.
+void compute_surface_normals(const uint64_t *opaque_mask, int64_t *out);
+
+/// Octahedral encoding of a unit vector: two snorm8 values, u in the low byte.
+uint16_t encode_oct16(float x, float y, float z);
+void decode_oct16(uint16_t oct, float out[3]);
+
+} // namespace voxel_normals
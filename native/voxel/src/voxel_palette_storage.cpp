@@ -0,0 +1,219 @@
+// voxel_palette_storage.cpp
+
+#include "voxel_palette_storage.h"
+
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+// Smallest supported index width (0/1/2/4/8) that can address `palette_size` entries.
+static inline int bits_for_palette_size(int palette_size) {
+    if (palette_size <= 1)  return 0;
+    if (palette_size <= 2)  return 1;
+    if (palette_size <= 4)  return 2;
+    if (palette_size <= 16) return 4;
+    return 8;
+}
+
+static inline size_t word_count_for_bits(int bits) {
+    return size_t(VoxelPaletteStorage::VOXEL_COUNT) * bits / 64;
+}
+
+// `value` replicated into every `bits`-wide slot of a 64-bit word.
+static inline uint64_t replicate_index(uint32_t value, int bits) {
+    return uint64_t(value) * (~0ull / ((1ull << bits) - 1));
+}
+
+// -----------------------------------------------------------------------------
+// VoxelPaletteStorage
+// -----------------------------------------------------------------------------
+
+VoxelPaletteStorage::VoxelPaletteStorage(uint8_t fill_material) {
+    memset(lookup, 0, sizeof(lookup));
+    fill(fill_material);
+}
+
+int VoxelPaletteStorage::find_palette_index(uint8_t material) const {
+    const int idx = lookup[material];
+    return (idx < (int)palette.size() && palette[idx] == material) ? idx : -1;
+}
+
+int VoxelPaletteStorage::add_palette_entry(uint8_t material) {
+    palette.push_back(material);
+    const int idx = (int)palette.size() - 1;
+    lookup[material] = (uint8_t)idx;
+
+    const int needed = bits_for_palette_size((int)palette.size());
+    if (needed > bits) {
+        repack(needed);
+    }
+    return idx;
+}
+
+void VoxelPaletteStorage::repack(int new_bits) {
+    if (new_bits == bits) {
+        return;
+    }
+
+    // Always a fresh array, so a copy sharing the old one is unaffected.
+    SharedWords new_words;
+    if (new_bits != 0) {
+        new_words = SharedWords(word_count_for_bits(new_bits));
+    }
+
+    if (bits != 0 && new_bits != 0) {
+        const int per_word = 64 / new_bits;
+        for (size_t w = 0; w < new_words->size(); ++w) {
+            uint64_t packed = 0;
+            const int base = int(w) * per_word;
+            for (int i = 0; i < per_word; ++i) {
+                packed |= uint64_t(read_index(base + i)) << (i * new_bits);
+            }
+            (*new_words)[w] = packed;
+        }
+    }
+    // From 0 bits every index is 0, which the zeroed words already encode.
+
+    words = std::move(new_words);
+    bits  = (uint8_t)new_bits;
+}
+
+uint8_t VoxelPaletteStorage::get_at(int idx) const {
+    if (bits == 0) {
+        return palette[0];
+    }
+    return palette[read_index(idx)];
+}
+
+void VoxelPaletteStorage::set_at(int idx, uint8_t material) {
+    int p = find_palette_index(material);
+    if (p < 0) {
+        p = add_palette_entry(material);
+    }
+    if (bits == 0) {
+        return; // uniform chunk already holds this material
+    }
+    detach();
+    write_index(idx, (uint32_t)p);
+}
+
+void VoxelPaletteStorage::fill(uint8_t material) {
+    palette.assign(1, material);
+    lookup[material] = 0;
+    words.reset();
+    bits = 0;
+}
+
+void VoxelPaletteStorage::fill_run(int idx, int count, uint8_t material) {
+    if (count <= 0) {
+        return;
+    }
+    if (idx == 0 && count >= VOXEL_COUNT) {
+        fill(material);
+        return;
+    }
+
+    int p = find_palette_index(material);
+    if (p < 0) {
+        p = add_palette_entry(material);
+    }
+    if (bits == 0) {
+        return;
+    }
+    detach();
+
+    const int per_word = 64 / bits;
+    int end = idx + count;
+
+    // Leading partial word.
+    while (idx < end && (idx % per_word) != 0) {
+        write_index(idx++, (uint32_t)p);
+    }
+
+    // Whole words at once.
+    const uint64_t pattern = replicate_index((uint32_t)p, bits);
+    while (end - idx >= per_word) {
+        (*words)[idx / per_word] = pattern;
+        idx += per_word;
+    }
+
+    // Trailing partial word.
+    while (idx < end) {
+        write_index(idx++, (uint32_t)p);
+    }
+}
+
+void VoxelPaletteStorage::unpack_zxy(uint8_t *dst_zxy) const {
+    if (bits == 0) {
+        memset(dst_zxy, palette[0], VOXEL_COUNT);
+        return;
+    }
+
+    const uint8_t  *pal      = palette.data();
+    const int       per_word = 64 / bits;
+    const uint64_t  mask     = (1ull << bits) - 1;
+    const size_t    n_words  = words->size();
+    const uint64_t *src      = words->data();
+
+    uint8_t *dst = dst_zxy;
+    for (size_t w = 0; w < n_words; ++w) {
+        uint64_t word = src[w];
+        for (int i = 0; i < per_word; ++i) {
+            dst[i] = pal[word & mask];
+            word >>= bits;
+        }
+        dst += per_word;
+    }
+}
+
+void VoxelPaletteStorage::pack_zxy(const uint8_t *src_zxy) {
+    bool present[256] = {};
+    for (int i = 0; i < VOXEL_COUNT; ++i) {
+        present[src_zxy[i]] = true;
+    }
+
+    palette.clear();
+    for (int m = 0; m < 256; ++m) {
+        if (present[m]) {
+            lookup[m] = (uint8_t)palette.size();
+            palette.push_back((uint8_t)m);
+        }
+    }
+
+    const int new_bits = bits_for_palette_size((int)palette.size());
+    if (new_bits == 0) {
+        fill(palette[0]);
+        return;
+    }
+
+    words = SharedWords(word_count_for_bits(new_bits));
+    bits  = (uint8_t)new_bits;
+
+    const int per_word = 64 / bits;
+    const uint8_t *src = src_zxy;
+    uint64_t *dst = words->data();
+    for (size_t w = 0; w < words->size(); ++w) {
+        uint64_t packed = 0;
+        for (int i = 0; i < per_word; ++i) {
+            packed |= uint64_t(lookup[src[i]]) << (i * bits);
+        }
+        dst[w] = packed;
+        src += per_word;
+    }
+}
+
+void VoxelPaletteStorage::compact() {
+    if (bits == 0) {
+        return;
+    }
+
+    std::vector<uint8_t> voxels(VOXEL_COUNT);
+    unpack_zxy(voxels.data());
+    pack_zxy(voxels.data());
+}
+
+size_t VoxelPaletteStorage::get_memory_usage() const {
+    return sizeof(*this) + palette.capacity() + (words ? words->capacity() * sizeof(uint64_t) : 0);
+}
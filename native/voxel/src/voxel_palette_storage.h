@@ -0,0 +1,151 @@
+// voxel_palette_storage.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+/// Palette-compressed storage for one padded 64^3 chunk of material ids.
+///
+/// Keeps a local palette of the materials present in the chunk plus
+/// bit-packed palette indices. The index width is 0, 1, 2, 4 or 8 bits and
+/// grows automatically when a write introduces a new material, so a uniform
+/// chunk costs no index memory and typical terrain (air, stone, dirt, grass)
+/// needs 2-4 bits per voxel instead of 8.
+///
+/// Voxels are addressed in the mesher's ZXY order (z fastest):
+///   idx = z + x*64 + y*64*64
+/// so unpack_zxy() writes straight into the mesher scratch buffer.
+///
+/// Copies are copy-on-write: the packed indices are shared between copies
+/// and only duplicated by the first write to a shared copy, so snapshotting
+/// a chunk (VoxelChunk::snapshot) costs a refcount bump and a palette copy.
+/// Dropping a copy releases the indices (release order) and a writer checks
+/// the count with acquire order, so a copy read and dropped on another
+/// thread is done with the indices before they are written in place.
+///
+/// Not thread-safe: callers synchronise access (see VoxelChunk). Separate
+/// copies may be used from different threads.
+class VoxelPaletteStorage {
+public:
+    static constexpr int SIZE        = 64;
+    static constexpr int VOXEL_COUNT = SIZE * SIZE * SIZE;
+
+    explicit VoxelPaletteStorage(uint8_t fill_material = 0);
+
+    static inline int index_zxy(int x, int y, int z) {
+        return z + x * SIZE + y * SIZE * SIZE;
+    }
+
+    uint8_t get(int x, int y, int z) const { return get_at(index_zxy(x, y, z)); }
+    void set(int x, int y, int z, uint8_t material) { set_at(index_zxy(x, y, z), material); }
+
+    /// Access by linear ZXY index (no bounds checks).
+    uint8_t get_at(int idx) const;
+    void set_at(int idx, uint8_t material);
+
+    /// Reset every voxel to one material (drops the index array).
+    void fill(uint8_t material);
+
+    /// Write `count` voxels of `material` starting at linear ZXY index `idx`.
+    void fill_run(int idx, int count, uint8_t material);
+
+    /// Bulk decode all 64^3 voxels into `dst_zxy` (VOXEL_COUNT bytes).
+    void unpack_zxy(uint8_t *dst_zxy) const;
+
+    /// Rebuild from raw ZXY voxels (VOXEL_COUNT bytes) with the smallest
+    /// palette and bit width that can represent them.
+    void pack_zxy(const uint8_t *src_zxy);
+
+    /// Drop palette entries no voxel references any more and shrink the
+    /// index width to match.
+    void compact();
+
+    bool is_uniform() const { return bits == 0; }
+    int get_bits_per_voxel() const { return bits; }
+    int get_palette_size() const { return (int)palette.size(); }
+    const uint8_t *get_palette() const { return palette.data(); }
+
+    /// True if `material` is in the palette (it may still be unreferenced
+    /// until compact() runs).
+    bool has_material(uint8_t material) const { return find_palette_index(material) >= 0; }
+
+    /// Resident bytes for the palette and packed indices.
+    size_t get_memory_usage() const;
+
+private:
+    typedef std::vector<uint64_t> Words;
+
+    /// Refcounted handle to index words. Not std::shared_ptr: its
+    /// use_count() is a relaxed load, which orders nothing.
+    class SharedWords {
+    public:
+        SharedWords() = default;
+        explicit SharedWords(size_t count) : block(new Block{ Words(count, 0) }) {}
+        explicit SharedWords(const Words &data) : block(new Block{ data }) {}
+        SharedWords(const SharedWords &o) : block(o.block) {
+            if (block) {
+                block->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        SharedWords(SharedWords &&o) noexcept : block(o.block) { o.block = nullptr; }
+        SharedWords &operator=(SharedWords o) {
+            std::swap(block, o.block);
+            return *this;
+        }
+        ~SharedWords() { reset(); }
+
+        void reset() {
+            if (block && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete block;
+            }
+            block = nullptr;
+        }
+
+        /// Whether another copy still refers to these words.
+        bool is_shared() const { return block && block->refs.load(std::memory_order_acquire) > 1; }
+
+        explicit operator bool() const { return block != nullptr; }
+        Words &operator*() const { return block->data; }
+        Words *operator->() const { return &block->data; }
+
+    private:
+        struct Block {
+            Words                 data;
+            std::atomic<uint32_t> refs{ 1 };
+        };
+
+        Block *block = nullptr;
+    };
+
+    std::vector<uint8_t>   palette;       // palette index -> material id
+    SharedWords            words;         // packed palette indices, shared between copies; null if bits == 0
+    uint8_t                lookup[256];   // material id -> palette index (valid if palette[lookup[m]] == m)
+    uint8_t                bits = 0;      // 0, 1, 2, 4 or 8
+
+    int find_palette_index(uint8_t material) const;
+    int add_palette_entry(uint8_t material);
+    void repack(int new_bits);
+
+    /// Give this copy its own index words before writing to them.
+    inline void detach() {
+        if (words.is_shared()) {
+            words = SharedWords(*words);
+        }
+    }
+
+    inline uint32_t read_index(int idx) const {
+        const uint32_t bit = uint32_t(idx) * bits;
+        return uint32_t((*words)[bit >> 6] >> (bit & 63)) & ((1u << bits) - 1);
+    }
+
+    inline void write_index(int idx, uint32_t value) {
+        const uint32_t bit   = uint32_t(idx) * bits;
+        const uint64_t mask  = uint64_t((1u << bits) - 1) << (bit & 63);
+        uint64_t      &word  = (*words)[bit >> 6];
+        word = (word & ~mask) | (uint64_t(value) << (bit & 63));
+    }
+};
@@ -0,0 +1,285 @@
+// voxel_prefab.cpp
+
+#include "voxel_prefab.h"
+#include "voxel_layout.h"
+#include "voxel_rle.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Serialized format
+// -----------------------------------------------------------------------------
+
+static constexpr uint8_t  PREFAB_MAGIC[4] = { 'V', 'X', 'P', 'F' };
+static constexpr uint16_t PREFAB_VERSION  = 1;
+static constexpr int      HEADER_SIZE     = 16;   // magic, version, size[3], run bytes
+
+static inline void write_u16(uint8_t *p, uint16_t v) {
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+}
+
+static inline void write_u32(uint8_t *p, uint32_t v) {
+    write_u16(p, uint16_t(v));
+    write_u16(p + 2, uint16_t(v >> 16));
+}
+
+static inline uint16_t read_u16(const uint8_t *p) {
+    return uint16_t(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read_u32(const uint8_t *p) {
+    return uint32_t(read_u16(p)) | (uint32_t(read_u16(p + 2)) << 16);
+}
+
+static inline bool size_is_valid(const Vector3i &s) {
+    return s.x > 0 && s.y > 0 && s.z > 0
+        && s.x <= VoxelPrefab::MAX_SIZE && s.y <= VoxelPrefab::MAX_SIZE && s.z <= VoxelPrefab::MAX_SIZE;
+}
+
+static inline int64_t volume_of(const Vector3i &s) {
+    return int64_t(s.x) * s.y * s.z;
+}
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelPrefab::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_voxels", "size", "materials_xyz"), &VoxelPrefab::set_voxels);
+    ClassDB::bind_method(D_METHOD("get_voxels"), &VoxelPrefab::get_voxels);
+    ClassDB::bind_method(D_METHOD("get_voxel", "x", "y", "z"), &VoxelPrefab::get_voxel);
+
+    ClassDB::bind_method(D_METHOD("get_size"), &VoxelPrefab::get_size);
+    ClassDB::bind_method(D_METHOD("get_run_count"), &VoxelPrefab::get_run_count);
+    ClassDB::bind_method(D_METHOD("get_compressed_size"), &VoxelPrefab::get_compressed_size);
+
+    ClassDB::bind_method(D_METHOD("to_bytes"), &VoxelPrefab::to_bytes);
+    ClassDB::bind_method(D_METHOD("from_bytes", "bytes"), &VoxelPrefab::from_bytes);
+
+    BIND_ENUM_CONSTANT(STAMP_REPLACE_AIR);
+    BIND_ENUM_CONSTANT(STAMP_REPLACE_ALL);
+    BIND_ENUM_CONSTANT(STAMP_OVERWRITE);
+}
+
+// -----------------------------------------------------------------------------
+// Building & reading
+// -----------------------------------------------------------------------------
+
+bool VoxelPrefab::set_voxels(const Vector3i &p_size, const PackedByteArray &materials_xyz) {
+    ERR_FAIL_COND_V_MSG(!size_is_valid(p_size), false, "Prefab size must be 1..1024 on every axis.");
+    ERR_FAIL_COND_V_MSG(materials_xyz.size() != volume_of(p_size), false, "Prefab voxel array does not match its size.");
+
+    const int sx = p_size.x;
+    const int sy = p_size.y;
+    const int sz = p_size.z;
+    const uint8_t *src = materials_xyz.ptr();
+
+    // Reorder to the blit order: z fastest, then x, then y.
+    std::vector<uint8_t> ordered((size_t)volume_of(p_size));
+    uint8_t *dst = ordered.data();
+    for (int y = 0; y < sy; ++y) {
+        for (int x = 0; x < sx; ++x) {
+            for (int z = 0; z < sz; ++z) {
+                *dst++ = src[x + y * sx + z * sx * sy];
+            }
+        }
+    }
+
+    std::vector<uint8_t> encoded(voxel_rle::max_encoded_size_v1(ordered.size()));
+    const size_t encoded_size = voxel_rle::encode_v1(ordered.data(), ordered.size(), encoded.data());
+
+    size = p_size;
+    runs.resize(encoded_size);
+    memcpy(runs.ptr(), encoded.data(), encoded_size);
+    return true;
+}
+
+PackedByteArray VoxelPrefab::get_voxels() const {
+    PackedByteArray out;
+    if (runs.is_empty()) {
+        return out;
+    }
+
+    const int sx = size.x;
+    const int sy = size.y;
+    const int sz = size.z;
+    out.resize(volume_of(size));
+    uint8_t *dst = out.ptrw();
+
+    int64_t pos = 0;
+    for (uint32_t r = 0; r < runs.size(); r += 2) {
+        const uint8_t material = runs[r];
+        for (int k = 0; k < runs[r + 1]; ++k, ++pos) {
+            const int64_t row = pos / sz;
+            const int z = int(pos - row * sz);
+            const int x = int(row % sx);
+            const int y = int(row / sx);
+            dst[x + y * sx + z * sx * sy] = material;
+        }
+    }
+    return out;
+}
+
+int VoxelPrefab::get_voxel(int x, int y, int z) const {
+    if ((unsigned)x >= (unsigned)size.x || (unsigned)y >= (unsigned)size.y || (unsigned)z >= (unsigned)size.z) {
+        return 0;
+    }
+
+    const int64_t target = z + (int64_t(x) + int64_t(y) * size.x) * size.z;
+    int64_t pos = 0;
+    for (uint32_t r = 0; r < runs.size(); r += 2) {
+        pos += runs[r + 1];
+        if (pos > target) {
+            return runs[r];
+        }
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Serialization
+// -----------------------------------------------------------------------------
+
+PackedByteArray VoxelPrefab::to_bytes() const {
+    PackedByteArray out;
+    if (runs.is_empty()) {
+        return out;
+    }
+
+    out.resize(HEADER_SIZE + runs.size());
+    uint8_t *p = out.ptrw();
+    memcpy(p, PREFAB_MAGIC, 4);
+    write_u16(p + 4, PREFAB_VERSION);
+    write_u16(p + 6, uint16_t(size.x));
+    write_u16(p + 8, uint16_t(size.y));
+    write_u16(p + 10, uint16_t(size.z));
+    write_u32(p + 12, runs.size());
+    memcpy(p + HEADER_SIZE, runs.ptr(), runs.size());
+    return out;
+}
+
+bool VoxelPrefab::from_bytes(const PackedByteArray &bytes) {
+    ERR_FAIL_COND_V_MSG(bytes.size() < HEADER_SIZE, false, "Prefab data is truncated.");
+
+    const uint8_t *p = bytes.ptr();
+    ERR_FAIL_COND_V_MSG(memcmp(p, PREFAB_MAGIC, 4) != 0, false, "Not prefab data (bad magic).");
+    ERR_FAIL_COND_V_MSG(read_u16(p + 4) != PREFAB_VERSION, false, "Unsupported prefab version.");
+
+    const Vector3i p_size(read_u16(p + 6), read_u16(p + 8), read_u16(p + 10));
+    const uint32_t run_bytes = read_u32(p + 12);
+    ERR_FAIL_COND_V_MSG(!size_is_valid(p_size), false, "Prefab size is out of range.");
+    ERR_FAIL_COND_V_MSG(run_bytes % 2 != 0 || int64_t(bytes.size()) != HEADER_SIZE + int64_t(run_bytes), false, "Prefab data is truncated.");
+
+    // The runs must cover the volume exactly, or blits would read past it.
+    const uint8_t *src = p + HEADER_SIZE;
+    int64_t total = 0;
+    for (uint32_t r = 0; r < run_bytes; r += 2) {
+        total += src[r + 1];
+    }
+    ERR_FAIL_COND_V_MSG(total != volume_of(p_size), false, "Prefab runs do not match its size.");
+
+    size = p_size;
+    runs.resize(run_bytes);
+    memcpy(runs.ptr(), src, run_bytes);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Blit
+// -----------------------------------------------------------------------------
+
+bool VoxelPrefab::blit_zxy(uint8_t *voxels_zxy, const Vector3i &offset, const Vector3i &lo, const Vector3i &hi,
+        StampMode mode, Vector3i &dirty_min, Vector3i &dirty_max) const {
+    const int sx = size.x;
+    const int sz = size.z;
+    const bool write_air = mode == STAMP_OVERWRITE;
+    bool changed = false;
+
+    int64_t pos = 0;
+    for (uint32_t r = 0; r < runs.size(); r += 2) {
+        const uint8_t material = runs[r];
+        const int     length   = runs[r + 1];
+
+        if (material == 0 && !write_air) {
+            pos += length;
+            continue;
+        }
+
+        // Split the run at prefab row ends; each piece is one chunk z row.
+        int64_t p = pos;
+        int remaining = length;
+        pos += length;
+
+        while (remaining > 0) {
+            const int64_t row = p / sz;
+            const int z0  = int(p - row * sz);
+            const int seg = std::min(remaining, sz - z0);
+            p += seg;
+            remaining -= seg;
+
+            const int ly = offset.y + int(row / sx);
+            if (ly >= hi.y) {
+                return changed;   // rows only move up from here
+            }
+            const int lx = offset.x + int(row % sx);
+            if (ly < lo.y || lx < lo.x || lx >= hi.x) {
+                continue;
+            }
+
+            const int za = std::max(offset.z + z0, lo.z);
+            const int zb = std::min(offset.z + z0 + seg, hi.z);
+            if (za >= zb) {
+                continue;
+            }
+
+            uint8_t *dst = voxels_zxy + voxel_layout::index_zxy(lx, ly, za);
+            const int len = zb - za;
+            int first = -1;
+            int last  = -1;
+
+            if (mode == STAMP_REPLACE_AIR) {
+                for (int k = 0; k < len; ++k) {
+                    if (dst[k] == 0) {
+                        dst[k] = material;
+                        if (first < 0) first = k;
+                        last = k;
+                    }
+                }
+            } else {
+                for (int k = 0; k < len; ++k) {
+                    if (dst[k] != material) {
+                        if (first < 0) first = k;
+                        last = k;
+                    }
+                }
+                if (first >= 0) {
+                    memset(dst + first, material, last - first + 1);
+                }
+            }
+
+            if (first < 0) {
+                continue;
+            }
+
+            const Vector3i row_min(lx, ly, za + first);
+            const Vector3i row_max(lx, ly, za + last);
+            if (changed) {
+                dirty_min = dirty_min.min(row_min);
+                dirty_max = dirty_max.max(row_max);
+            } else {
+                dirty_min = row_min;
+                dirty_max = row_max;
+                changed   = true;
+            }
+        }
+    }
+
+    return changed;
+}
@@ -0,0 +1,77 @@
+// voxel_prefab.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+using namespace godot;
+
+/// Run-length compressed block of voxels (a tree, a ruin, a building) that
+/// VoxelEdit::stamp() blits into the world.
+///
+/// Voxels are stored as voxel_rle.h v1 runs (material, length <= 255) in
+/// z-fastest order, then x, then y: one (x, y) row of the prefab lands on
+/// one contiguous z run of a chunk's ZXY buffer, so a blit is a memset per
+/// run segment. Material 0 is air; depending on the stamp mode it is either
+/// skipped as a whole run or written to carve.
+///
+/// The serialized form (to_bytes / from_bytes) is a 16-byte header
+/// ("VXPF", version, size x/y/z as uint16) followed by the runs.
+class VoxelPrefab : public RefCounted {
+    GDCLASS(VoxelPrefab, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    enum StampMode {
+        /// Write solid prefab voxels into air only; existing terrain wins.
+        STAMP_REPLACE_AIR,
+        /// Write solid prefab voxels over anything; prefab air is skipped.
+        STAMP_REPLACE_ALL,
+        /// Write every prefab voxel, air included (carves a clearing).
+        STAMP_OVERWRITE,
+    };
+
+    /// Largest size per axis (keeps serialized sizes in 16 bits).
+    static constexpr int MAX_SIZE = 1024;
+
+    VoxelPrefab() = default;
+    ~VoxelPrefab() = default;
+
+    /// Build from `size.x * size.y * size.z` bytes in XYZ layout
+    /// (idx = x + y*size.x + z*size.x*size.y). Returns false if the
+    /// size is out of range or does not match the array.
+    bool set_voxels(const Vector3i &p_size, const PackedByteArray &materials_xyz);
+
+    /// Decode back to the XYZ layout taken by set_voxels().
+    PackedByteArray get_voxels() const;
+
+    /// Material at a prefab-local position (0 outside). Walks the runs.
+    int get_voxel(int x, int y, int z) const;
+
+    Vector3i get_size() const { return size; }
+    int get_run_count() const { return (int)(runs.size() / 2); }
+    int get_compressed_size() const { return (int)runs.size(); }
+
+    PackedByteArray to_bytes() const;
+    bool from_bytes(const PackedByteArray &bytes);
+
+    // --- Native access (not bound) ---
+
+    /// Blit into a 64^3 ZXY chunk buffer. `offset` is the position of the
+    /// prefab's (0, 0, 0) in chunk-local coordinates (may be negative);
+    /// writes are clipped to the local box [lo, hi). Grows the inclusive
+    /// local bounds [dirty_min, dirty_max] by the voxels that changed and
+    /// returns true if any did.
+    bool blit_zxy(uint8_t *voxels_zxy, const Vector3i &offset, const Vector3i &lo, const Vector3i &hi,
+            StampMode mode, Vector3i &dirty_min, Vector3i &dirty_max) const;
+
+private:
+    Vector3i             size;
+    LocalVector<uint8_t> runs;   // (material, length) pairs
+};
+
+VARIANT_ENUM_CAST(VoxelPrefab::StampMode);
@@ -0,0 +1,762 @@
+// voxel_region.cpp
+
+#include "voxel_region.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <string.h>
+
+namespace voxel_region {
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+// Header field offsets within a header slot sector.
+static constexpr int H_MAGIC          = 0;
+static constexpr int H_VERSION        = 4;
+static constexpr int H_SECTOR_SIZE    = 8;
+static constexpr int H_CHUNK_COUNT    = 12;
+static constexpr int H_TABLE_OFFSET   = 16;
+static constexpr int H_TABLE_SIZE     = 24;
+static constexpr int H_TABLE_CHECKSUM = 32;
+static constexpr int H_SEQUENCE       = 36;
+static constexpr int H_CHECKSUM       = 44;   // over bytes [0, H_CHECKSUM)
+
+static inline void write_u32(uint8_t *p, uint32_t v) {
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+    p[2] = uint8_t(v >> 16);
+    p[3] = uint8_t(v >> 24);
+}
+
+static inline void write_u64(uint8_t *p, uint64_t v) {
+    write_u32(p, uint32_t(v));
+    write_u32(p + 4, uint32_t(v >> 32));
+}
+
+static inline uint32_t read_u32(const uint8_t *p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static inline uint64_t read_u64(const uint8_t *p) {
+    return uint64_t(read_u32(p)) | (uint64_t(read_u32(p + 4)) << 32);
+}
+
+// FNV-1a; catches torn or stale table and header writes, not tampering.
+static uint32_t checksum(const uint8_t *p, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Commit `sequence` goes to slot sequence % HEADER_SECTORS, so a commit
+// never overwrites the header of the one before it.
+static bool write_header(VoxelFileIO &file, uint64_t sequence, uint32_t chunk_count, uint64_t table_offset,
+        uint64_t table_size, uint32_t table_checksum) {
+    uint8_t sector[SECTOR_SIZE] = {};
+    memcpy(sector + H_MAGIC, MAGIC, 4);
+    write_u32(sector + H_VERSION, VERSION);
+    write_u32(sector + H_SECTOR_SIZE, SECTOR_SIZE);
+    write_u32(sector + H_CHUNK_COUNT, chunk_count);
+    write_u64(sector + H_TABLE_OFFSET, table_offset);
+    write_u64(sector + H_TABLE_SIZE, table_size);
+    write_u32(sector + H_TABLE_CHECKSUM, table_checksum);
+    write_u64(sector + H_SEQUENCE, sequence);
+    write_u32(sector + H_CHECKSUM, checksum(sector, H_CHECKSUM));
+    return file.write_at((sequence % HEADER_SECTORS) * SECTOR_SIZE, sector, SECTOR_SIZE);
+}
+
+// Header of a new file: commit 0 in slot 0, slot 1 left empty (invalid).
+static bool write_first_header(VoxelFileIO &file, uint32_t chunk_count, uint64_t table_offset,
+        uint64_t table_size, uint32_t table_checksum) {
+    static const uint8_t empty[SECTOR_SIZE] = {};
+    return write_header(file, 0, chunk_count, table_offset, table_size, table_checksum)
+            && file.write_at(SECTOR_SIZE, empty, SECTOR_SIZE);
+}
+
+static bool read_header(const uint8_t *sector, RegionFile::Header &out) {
+    if (memcmp(sector + H_MAGIC, MAGIC, 4) != 0
+            || read_u32(sector + H_VERSION) != VERSION
+            || read_u32(sector + H_SECTOR_SIZE) != SECTOR_SIZE
+            || read_u32(sector + H_CHECKSUM) != checksum(sector, H_CHECKSUM)) {
+        return false;
+    }
+    out.sequence       = read_u64(sector + H_SEQUENCE);
+    out.chunk_count    = read_u32(sector + H_CHUNK_COUNT);
+    out.table_offset   = read_u64(sector + H_TABLE_OFFSET);
+    out.table_size     = read_u64(sector + H_TABLE_SIZE);
+    out.table_checksum = read_u32(sector + H_TABLE_CHECKSUM);
+    return true;
+}
+
+// Spread the low 21 bits of v to every third bit.
+static inline uint64_t spread_bits_3(uint32_t v) {
+    uint64_t x = v & 0x1FFFFF;
+    x = (x | (x << 32)) & 0x001F00000000FFFFull;
+    x = (x | (x << 16)) & 0x001F0000FF0000FFull;
+    x = (x | (x << 8))  & 0x100F00F00F00F00Full;
+    x = (x | (x << 4))  & 0x10C30C30C30C30C3ull;
+    x = (x | (x << 2))  & 0x1249249249249249ull;
+    return x;
+}
+
+uint64_t morton_key(const ChunkCoord &c) {
+    const uint32_t bias = 1u << 20;
+    return spread_bits_3(uint32_t(c.x) + bias)
+         | (spread_bits_3(uint32_t(c.y) + bias) << 1)
+         | (spread_bits_3(uint32_t(c.z) + bias) << 2);
+}
+
+// Per-thread staging for batched writes and coalesced reads.
+static thread_local std::vector<uint8_t> g_write_batch;
+static thread_local std::vector<uint8_t> g_read_span;
+
+uint64_t RegionFile::sectors_for(uint64_t bytes) {
+    return (bytes + SECTOR_SIZE - 1) / SECTOR_SIZE;
+}
+
+void RegionFile::write_table_entry(uint8_t *p, const Entry &e) {
+    write_u32(p, uint32_t(e.coord.x));
+    write_u32(p + 4, uint32_t(e.coord.y));
+    write_u32(p + 8, uint32_t(e.coord.z));
+    write_u32(p + 12, e.size);
+    if (e.size <= INLINE_SIZE) {
+        memcpy(p + 16, e.inline_data, INLINE_SIZE);
+    } else {
+        write_u64(p + 16, e.extent.sector * SECTOR_SIZE);
+        memset(p + 24, 0, 8);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Opening
+// -----------------------------------------------------------------------------
+
+bool RegionFile::open(const std::string &p_path, bool create) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    writes_done.wait(guard, [this] { return pending_writes == 0; });
+
+    file.close();
+    entries.clear();
+    free_extents.clear();
+    pending_release.clear();
+    table_extent = Extent();
+    sequence     = 0;
+    end_sector   = HEADER_SECTORS;
+    dirty        = false;
+    ++generation;
+    ++epoch;
+    path         = p_path;
+
+    if (!file.open(path, create)) {
+        return false;
+    }
+
+    const bool ok = file.get_size() == 0 ? create && initialize() : load();
+    if (!ok) {
+        file.close();
+        entries.clear();
+        free_extents.clear();
+    }
+    return ok;
+}
+
+void RegionFile::close() {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    writes_done.wait(guard, [this] { return pending_writes == 0; });
+    file.close();
+    entries.clear();
+    free_extents.clear();
+    pending_release.clear();
+    dirty = false;
+    ++generation;
+    ++epoch;
+}
+
+bool RegionFile::is_open() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return file.is_open();
+}
+
+bool RegionFile::initialize() {
+    return write_first_header(file, 0, 0, 0, checksum(nullptr, 0)) && file.sync();
+}
+
+bool RegionFile::load() {
+    const uint64_t file_size = file.get_size();
+    uint8_t sectors[HEADER_SECTORS * SECTOR_SIZE];
+    if (file_size < sizeof(sectors) || !file.read_at(0, sectors, sizeof(sectors))) {
+        return false;
+    }
+
+    // Newest commit first. A torn or corrupt slot, or one whose table does
+    // not check out, falls back to the commit before it.
+    Header headers[HEADER_SECTORS];
+    int valid = 0;
+    for (uint32_t slot = 0; slot < HEADER_SECTORS; ++slot) {
+        if (read_header(sectors + slot * SECTOR_SIZE, headers[valid])) {
+            ++valid;
+        }
+    }
+    if (valid == 2 && headers[1].sequence > headers[0].sequence) {
+        std::swap(headers[0], headers[1]);
+    }
+
+    for (int i = 0; i < valid; ++i) {
+        if (load_table(headers[i], file_size)) {
+            sequence = headers[i].sequence;
+            return true;
+        }
+        entries.clear();
+        free_extents.clear();
+        table_extent = Extent();
+        end_sector   = HEADER_SECTORS;
+    }
+    return false;
+}
+
+bool RegionFile::load_table(const Header &h, uint64_t file_size) {
+    const uint32_t count        = h.chunk_count;
+    const uint64_t table_offset = h.table_offset;
+    const uint64_t table_size   = h.table_size;
+    const uint64_t data_start   = HEADER_SECTORS * SECTOR_SIZE;
+    if (table_size != uint64_t(count) * TABLE_ENTRY_SIZE || table_offset % SECTOR_SIZE != 0
+            || (table_size > 0 && (table_offset < data_start || table_offset + table_size > file_size))) {
+        return false;
+    }
+
+    std::vector<uint8_t> table(table_size);
+    if (table_size > 0 && !file.read_at(table_offset, table.data(), table_size)) {
+        return false;
+    }
+    if (h.table_checksum != checksum(table.data(), table.size())) {
+        return false;
+    }
+
+    // Every sector in use: the header slots, the table and non-inline
+    // payloads.
+    std::vector<Extent> used;
+    used.reserve(count + 2);
+    used.push_back(Extent{ 0, HEADER_SECTORS });
+    if (table_size > 0) {
+        table_extent = Extent{ table_offset / SECTOR_SIZE, sectors_for(table_size) };
+        used.push_back(table_extent);
+    }
+
+    entries.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint8_t *p = table.data() + size_t(i) * TABLE_ENTRY_SIZE;
+
+        Entry e;
+        e.coord = ChunkCoord{ int32_t(read_u32(p)), int32_t(read_u32(p + 4)), int32_t(read_u32(p + 8)) };
+        e.size  = read_u32(p + 12);
+        if (e.size <= INLINE_SIZE) {
+            memcpy(e.inline_data, p + 16, INLINE_SIZE);
+        } else {
+            const uint64_t offset = read_u64(p + 16);
+            if (offset % SECTOR_SIZE != 0 || offset < data_start || offset + e.size > file_size) {
+                return false;
+            }
+            e.extent = Extent{ offset / SECTOR_SIZE, sectors_for(e.size) };
+            used.push_back(e.extent);
+        }
+        entries[e.coord] = e;
+    }
+
+    // Free space is whatever lies between used extents. Overlaps mean the
+    // table is corrupt.
+    std::sort(used.begin(), used.end(), [](const Extent &a, const Extent &b) { return a.sector < b.sector; });
+    uint64_t cursor = 0;
+    for (const Extent &e : used) {
+        if (e.sector < cursor) {
+            return false;
+        }
+        if (e.sector > cursor) {
+            free_extents[cursor] = e.sector - cursor;
+        }
+        cursor = e.sector + e.count;
+    }
+    end_sector = cursor;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Allocation
+// -----------------------------------------------------------------------------
+
+RegionFile::Extent RegionFile::allocate(uint64_t count) {
+    for (auto it = free_extents.begin(); it != free_extents.end(); ++it) {
+        if (it->second < count) {
+            continue;
+        }
+        const Extent e{ it->first, count };
+        const uint64_t rest = it->second - count;
+        free_extents.erase(it);
+        if (rest > 0) {
+            free_extents[e.sector + count] = rest;
+        }
+        return e;
+    }
+
+    const Extent e{ end_sector, count };
+    end_sector += count;
+    return e;
+}
+
+void RegionFile::release(const Extent &e) {
+    if (e.count == 0) {
+        return;
+    }
+
+    uint64_t sector = e.sector;
+    uint64_t count  = e.count;
+
+    auto next = free_extents.lower_bound(sector);
+    if (next != free_extents.end() && next->first == sector + count) {
+        count += next->second;
+        next = free_extents.erase(next);
+    }
+    if (next != free_extents.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == sector) {
+            sector = prev->first;
+            count += prev->second;
+            free_extents.erase(prev);
+        }
+    }
+
+    if (sector + count == end_sector) {
+        end_sector = sector;
+    } else {
+        free_extents[sector] = count;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Chunks
+// -----------------------------------------------------------------------------
+
+bool RegionFile::has_chunk(const ChunkCoord &c) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return entries.find(c) != entries.end();
+}
+
+bool RegionFile::read_chunk(const ChunkCoord &c, std::vector<uint8_t> &out) const {
+    out.clear();
+
+    // The shared lock is held across the read so commit() cannot hand the
+    // extent to another writer underneath it.
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = entries.find(c);
+    if (it == entries.end()) {
+        return false;
+    }
+
+    const Entry &e = it->second;
+    out.resize(e.size);
+    if (e.size <= INLINE_SIZE) {
+        memcpy(out.data(), e.inline_data, e.size);
+        return true;
+    }
+    if (!file.read_at(e.extent.sector * SECTOR_SIZE, out.data(), e.size)) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+bool RegionFile::write_chunk(const ChunkCoord &c, const uint8_t *data, size_t size) {
+    const ChunkWrite write{ c, data, size };
+    return write_chunks(&write, 1);
+}
+
+bool RegionFile::write_chunks(const ChunkWrite *writes, size_t count) {
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (writes[i].size > UINT32_MAX) {
+            return false;
+        }
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [writes](size_t a, size_t b) {
+        return morton_key(writes[a].coord) < morton_key(writes[b].coord);
+    });
+
+    // Lay the payloads out relative to the start of one batch extent.
+    std::vector<Entry> batch(count);
+    uint64_t sectors = 0;
+    uint64_t length  = 0;
+    for (size_t k = 0; k < count; ++k) {
+        const ChunkWrite &w = writes[order[k]];
+        Entry &e = batch[k];
+        e.coord = w.coord;
+        e.size  = uint32_t(w.size);
+        memset(e.inline_data, 0, INLINE_SIZE);
+        if (w.size <= INLINE_SIZE) {
+            memcpy(e.inline_data, w.data, w.size);
+        } else {
+            e.extent = Extent{ sectors, sectors_for(w.size) };
+            length   = sectors * SECTOR_SIZE + w.size;
+            sectors += e.extent.count;
+        }
+    }
+
+    // open(), close() and compact() do not touch the file while
+    // pending_writes > 0; the epoch check backs that up, since an extent
+    // allocated from a file that has since been replaced means nothing.
+    uint64_t opened_epoch = 0;
+    if (sectors > 0) {
+        Extent extent;
+        {
+            std::unique_lock<std::shared_mutex> guard(lock);
+            if (!file.is_open()) {
+                return false;
+            }
+            extent = allocate(sectors);
+            opened_epoch = epoch;
+            ++pending_writes;
+        }
+
+        // The extent belongs to this call alone until it is installed, so
+        // the write itself runs without the lock.
+        const uint8_t *src = nullptr;
+        if (count == 1) {
+            src = writes[0].data;
+        } else {
+            g_write_batch.assign(length, 0);
+            for (size_t k = 0; k < count; ++k) {
+                if (batch[k].size > INLINE_SIZE) {
+                    memcpy(g_write_batch.data() + batch[k].extent.sector * SECTOR_SIZE, writes[order[k]].data, batch[k].size);
+                }
+            }
+            src = g_write_batch.data();
+        }
+        if (!file.write_at(extent.sector * SECTOR_SIZE, src, length)) {
+            std::unique_lock<std::shared_mutex> guard(lock);
+            if (epoch == opened_epoch) {
+                release(extent);
+            }
+            --pending_writes;
+            writes_done.notify_all();
+            return false;
+        }
+
+        for (Entry &e : batch) {
+            if (e.size > INLINE_SIZE) {
+                e.extent.sector += extent.sector;
+            }
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    if (sectors > 0) {
+        --pending_writes;
+        writes_done.notify_all();
+        if (epoch != opened_epoch) {
+            return false;
+        }
+    }
+    if (!file.is_open()) {
+        return false;
+    }
+    for (const Entry &e : batch) {
+        auto it = entries.find(e.coord);
+        if (it != entries.end()) {
+            pending_release.push_back(it->second.extent);
+            it->second = e;
+        } else {
+            entries.emplace(e.coord, e);
+        }
+    }
+    dirty = dirty || count > 0;
+    ++generation;
+    return true;
+}
+
+size_t RegionFile::read_chunks(ChunkRead *reads, size_t count) const {
+    struct PendingRead {
+        uint64_t offset;
+        uint32_t size;
+        size_t   index;
+    };
+
+    std::vector<PendingRead> pending;
+    pending.reserve(count);
+    size_t found = 0;
+    const uint64_t gap_limit = read_ahead.load(std::memory_order_relaxed);
+
+    // Shared lock across the reads, as in read_chunk().
+    std::shared_lock<std::shared_mutex> guard(lock);
+    for (size_t i = 0; i < count; ++i) {
+        ChunkRead &r = reads[i];
+        r.data.clear();
+        r.found = false;
+
+        auto it = entries.find(r.coord);
+        if (it == entries.end()) {
+            continue;
+        }
+        const Entry &e = it->second;
+        r.found = true;
+        ++found;
+        if (e.size <= INLINE_SIZE) {
+            r.data.assign(e.inline_data, e.inline_data + e.size);
+        } else {
+            pending.push_back(PendingRead{ e.extent.sector * SECTOR_SIZE, e.size, i });
+        }
+    }
+
+    std::sort(pending.begin(), pending.end(), [](const PendingRead &a, const PendingRead &b) {
+        return a.offset < b.offset;
+    });
+
+    for (size_t a = 0; a < pending.size();) {
+        const uint64_t start = pending[a].offset;
+        uint64_t end = start + pending[a].size;
+        size_t b = a + 1;
+        while (b < pending.size()) {
+            const uint64_t next_end = std::max(end, pending[b].offset + pending[b].size);
+            if (pending[b].offset > end + gap_limit || next_end - start > MAX_COALESCED_READ) {
+                break;
+            }
+            end = next_end;
+            ++b;
+        }
+
+        bool ok;
+        if (b == a + 1) {
+            std::vector<uint8_t> &data = reads[pending[a].index].data;
+            data.resize(pending[a].size);
+            ok = file.read_at(start, data.data(), data.size());
+        } else {
+            g_read_span.resize(end - start);
+            ok = file.read_at(start, g_read_span.data(), g_read_span.size());
+            for (size_t k = a; ok && k < b; ++k) {
+                const uint8_t *p = g_read_span.data() + (pending[k].offset - start);
+                reads[pending[k].index].data.assign(p, p + pending[k].size);
+            }
+        }
+
+        if (!ok) {
+            for (size_t k = a; k < b; ++k) {
+                ChunkRead &r = reads[pending[k].index];
+                r.data.clear();
+                r.found = false;
+                --found;
+            }
+        }
+        a = b;
+    }
+    return found;
+}
+
+void RegionFile::set_read_ahead(uint64_t bytes) {
+    read_ahead.store(bytes, std::memory_order_relaxed);
+}
+
+uint64_t RegionFile::get_read_ahead() const {
+    return read_ahead.load(std::memory_order_relaxed);
+}
+
+bool RegionFile::remove_chunk(const ChunkCoord &c) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    auto it = entries.find(c);
+    if (it == entries.end()) {
+        return false;
+    }
+    pending_release.push_back(it->second.extent);
+    entries.erase(it);
+    dirty = true;
+    ++generation;
+    return true;
+}
+
+bool RegionFile::commit() {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    if (!file.is_open()) {
+        return false;
+    }
+    if (!dirty) {
+        return true;
+    }
+
+    std::vector<uint8_t> table(entries.size() * TABLE_ENTRY_SIZE);
+    uint8_t *p = table.data();
+    for (const auto &kv : entries) {
+        write_table_entry(p, kv.second);
+        p += TABLE_ENTRY_SIZE;
+    }
+
+    // The new table goes to free sectors; the header still points at the
+    // old one until the payloads and the table are on disk.
+    const Extent t = table.empty() ? Extent() : allocate(sectors_for(table.size()));
+    const bool ok = (table.empty() || file.write_at(t.sector * SECTOR_SIZE, table.data(), table.size()))
+            && file.sync()
+            && write_header(file, sequence + 1, uint32_t(entries.size()), table.empty() ? 0 : t.sector * SECTOR_SIZE,
+                    table.size(), checksum(table.data(), table.size()))
+            && file.sync();
+    if (!ok) {
+        release(t);
+        return false;
+    }
+    ++sequence;
+
+    release(table_extent);
+    for (const Extent &e : pending_release) {
+        release(e);
+    }
+    pending_release.clear();
+    table_extent = t;
+    dirty = false;
+    return true;
+}
+
+bool RegionFile::has_uncommitted() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return dirty;
+}
+
+bool RegionFile::compact() {
+    const std::string compact_path = path + ".compact";
+    uint64_t snapshot;
+    std::error_code ec;
+
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        if (!file.is_open() || pending_writes > 0) {
+            return false;
+        }
+        snapshot = generation;
+
+        std::vector<Entry> live;
+        live.reserve(entries.size());
+        for (const auto &kv : entries) {
+            live.push_back(kv.second);
+        }
+        std::sort(live.begin(), live.end(), [](const Entry &a, const Entry &b) {
+            return morton_key(a.coord) < morton_key(b.coord);
+        });
+
+        VoxelFileIO out;
+        if (!out.open(compact_path, true) || !out.truncate(0)) {
+            return false;
+        }
+
+        // Payloads from the first sector after the header slots on, staged
+        // through a bounded buffer.
+        bool ok = true;
+        uint64_t next_sector = HEADER_SECTORS;
+        uint64_t staged_at   = HEADER_SECTORS * SECTOR_SIZE;
+        std::vector<uint8_t> staging;
+        std::vector<uint8_t> payload;
+        for (Entry &e : live) {
+            if (e.size <= INLINE_SIZE) {
+                continue;
+            }
+            payload.resize(e.size);
+            if (!file.read_at(e.extent.sector * SECTOR_SIZE, payload.data(), e.size)) {
+                ok = false;
+                break;
+            }
+            e.extent = Extent{ next_sector, sectors_for(e.size) };
+            next_sector += e.extent.count;
+
+            staging.resize(size_t(e.extent.sector * SECTOR_SIZE - staged_at), 0);
+            staging.insert(staging.end(), payload.begin(), payload.end());
+            if (staging.size() >= MAX_COALESCED_READ) {
+                ok = out.write_at(staged_at, staging.data(), staging.size());
+                staged_at += staging.size();
+                staging.clear();
+                if (!ok) {
+                    break;
+                }
+            }
+        }
+
+        std::vector<uint8_t> table(live.size() * TABLE_ENTRY_SIZE);
+        for (size_t i = 0; i < live.size(); ++i) {
+            write_table_entry(table.data() + i * TABLE_ENTRY_SIZE, live[i]);
+        }
+        const uint64_t table_offset = next_sector * SECTOR_SIZE;
+
+        ok = ok
+                && (staging.empty() || out.write_at(staged_at, staging.data(), staging.size()))
+                && (table.empty() || out.write_at(table_offset, table.data(), table.size()))
+                && write_first_header(out, uint32_t(live.size()), table.empty() ? 0 : table_offset,
+                        table.size(), checksum(table.data(), table.size()))
+                && out.sync();
+        out.close();
+        if (!ok) {
+            std::filesystem::remove(std::filesystem::u8path(compact_path), ec);
+            return false;
+        }
+    }
+
+    // A write that allocated sectors but has not installed its entries yet
+    // has not bumped `generation`, and its extent belongs to the old file.
+    std::unique_lock<std::shared_mutex> guard(lock);
+    if (generation != snapshot || pending_writes > 0 || !file.is_open()) {
+        std::filesystem::remove(std::filesystem::u8path(compact_path), ec);
+        return false;
+    }
+
+    file.close();
+    ++epoch;
+    const bool replaced = VoxelFileIO::replace(compact_path, path);
+    if (!replaced && std::filesystem::exists(std::filesystem::u8path(compact_path), ec)) {
+        // The original is untouched and the in-memory state still matches it.
+        std::filesystem::remove(std::filesystem::u8path(compact_path), ec);
+        file.open(path, false);
+        return false;
+    }
+
+    entries.clear();
+    free_extents.clear();
+    pending_release.clear();
+    table_extent = Extent();
+    sequence     = 0;
+    end_sector   = HEADER_SECTORS;
+    dirty        = false;
+    ++generation;
+    if (!file.open(path, false) || !load()) {
+        file.close();
+        entries.clear();
+        free_extents.clear();
+        return false;
+    }
+    // False if the rename went through but could not be synced.
+    return replaced;
+}
+
+void RegionFile::get_coords(std::vector<ChunkCoord> &out) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    out.clear();
+    out.reserve(entries.size());
+    for (const auto &kv : entries) {
+        out.push_back(kv.first);
+    }
+}
+
+Stats RegionFile::get_stats() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+
+    Stats s = {};
+    s.chunk_count = uint32_t(entries.size());
+    s.file_bytes  = end_sector * SECTOR_SIZE;
+    for (const auto &kv : entries) {
+        s.payload_bytes += kv.second.size;
+    }
+    for (const auto &kv : free_extents) {
+        s.free_bytes += kv.second * SECTOR_SIZE;
+    }
+    for (const Extent &e : pending_release) {
+        s.free_bytes += e.count * SECTOR_SIZE;
+    }
+    return s;
+}
+
+} // namespace voxel_region
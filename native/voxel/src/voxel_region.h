@@ -0,0 +1,225 @@
+// voxel_region.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "voxel_file_io.h"
+
+/// Growable on-disk chunk store.
+///
+/// Chunks are keyed by 3D integer coordinates and their payloads live at
+/// sector-aligned 64-bit offsets, so a file has no fixed world size and no
+/// preallocation. Layout:
+///
+///   sectors 0 and 1  header slots: magic "VXRG", version, sector size,
+///                    chunk count, table offset / size / checksum, commit
+///                    sequence number, header checksum
+///   other sectors    chunk payloads and the chunk table, in any order
+///
+/// Table entries are TABLE_ENTRY_SIZE bytes: x, y, z (int32), payload size
+/// (uint32) and 16 bytes that hold the payload's byte offset (uint64), or
+/// the payload itself when it fits (uniform chunks encode to 8 bytes and
+/// take no sectors at all). Everything is little endian.
+///
+/// write_chunk() puts the payload in free sectors (first fit, else at the
+/// end of the file) and never overwrites anything the committed table
+/// points at. commit() writes a new table the same way, syncs, then writes
+/// the header into the slot the current commit does not use, with the next
+/// sequence number; only then do the replaced extents become free. Opening
+/// takes the newest slot whose header and table checksums hold, so a crash
+/// at any point, including a torn header write, leaves the previous commit
+/// readable. A save only ever holds the chunks it writes plus the table in
+/// memory.
+///
+/// write_chunks() lays a batch out back to back in Morton order of the
+/// chunk coordinates, so a neighbourhood saved together is contiguous on
+/// disk, and read_chunks() turns a neighbourhood request into a few large
+/// sequential reads (see set_read_ahead()).
+///
+/// Together that makes every save a journal append: only the dirty chunks
+/// are written, the commit record is the header, and space freed by older
+/// saves is recycled. Fragmentation left behind (get_fragmentation()) is
+/// removed by compact(), which rewrites the live chunks in Morton order
+/// into a new file and swaps it in.
+///
+/// Reads take a shared lock, so any number of threads may read while
+/// writers only serialize on allocation and on installing table entries.
+namespace voxel_region {
+
+static constexpr uint8_t  MAGIC[4]         = { 'V', 'X', 'R', 'G' };
+static constexpr uint32_t VERSION          = 2;
+static constexpr uint32_t SECTOR_SIZE      = 512;
+static constexpr uint32_t HEADER_SIZE      = 48;   // per slot
+static constexpr uint32_t HEADER_SECTORS   = 2;
+static constexpr uint32_t TABLE_ENTRY_SIZE = 32;
+static constexpr uint32_t INLINE_SIZE      = 16;   // payloads up to this size live in the table
+
+static constexpr uint64_t DEFAULT_READ_AHEAD = 256 * 1024;
+static constexpr uint64_t MAX_COALESCED_READ = 8 * 1024 * 1024;
+
+struct ChunkCoord {
+    int32_t x, y, z;
+
+    bool operator==(const ChunkCoord &o) const { return x == o.x && y == o.y && z == o.z; }
+};
+
+struct ChunkCoordHash {
+    size_t operator()(const ChunkCoord &c) const {
+        const uint64_t h = (uint64_t(uint32_t(c.x)) * 0x9E3779B97F4A7C15ull)
+                         ^ (uint64_t(uint32_t(c.y)) * 0xC2B2AE3D27D4EB4Full)
+                         ^ (uint64_t(uint32_t(c.z)) * 0x165667B19E3779F9ull);
+        return size_t(h ^ (h >> 29));
+    }
+};
+
+/// Position on a 3D Z-order curve: 21 bits per axis (coordinates offset by
+/// 2^20), x in the lowest bit.
+uint64_t morton_key(const ChunkCoord &c);
+
+struct ChunkWrite {
+    ChunkCoord     coord;
+    const uint8_t *data;
+    size_t         size;
+};
+
+struct ChunkRead {
+    ChunkCoord           coord;
+    std::vector<uint8_t> data;
+    bool                 found = false;
+};
+
+struct Stats {
+    uint32_t chunk_count;
+    uint64_t file_bytes;     // end of the last allocated sector
+    uint64_t payload_bytes;  // sum of stored payload sizes
+    uint64_t free_bytes;     // reusable sectors, including ones freed by the next commit
+
+    /// Share of the file that is not live data, 0..1.
+    double get_fragmentation() const {
+        return file_bytes > HEADER_SECTORS * SECTOR_SIZE ? double(free_bytes) / double(file_bytes) : 0.0;
+    }
+};
+
+class RegionFile {
+public:
+    /// One decoded header slot.
+    struct Header {
+        uint64_t sequence;
+        uint32_t chunk_count;
+        uint64_t table_offset;
+        uint64_t table_size;
+        uint32_t table_checksum;
+    };
+
+    RegionFile() = default;
+    RegionFile(const RegionFile &) = delete;
+    RegionFile &operator=(const RegionFile &) = delete;
+
+    /// Open the store at `path` (UTF-8). With `create`, a missing or empty
+    /// file is initialised. Fails on a damaged header or table.
+    bool open(const std::string &path, bool create);
+
+    /// Close without committing; uncommitted writes are lost. Waits for
+    /// write_chunks() calls that are writing payloads (as does open()).
+    void close();
+    bool is_open() const;
+
+    bool has_chunk(const ChunkCoord &c) const;
+
+    /// Payload stored for `c`; false (and `out` empty) if there is none.
+    bool read_chunk(const ChunkCoord &c, std::vector<uint8_t> &out) const;
+
+    /// Store `size` bytes for `c`, replacing any previous payload. Visible
+    /// to readers at once, durable after the next commit().
+    bool write_chunk(const ChunkCoord &c, const uint8_t *data, size_t size);
+
+    /// write_chunk() for a batch: the payloads are sorted by morton_key(),
+    /// placed back to back (each sector aligned) in one extent and written
+    /// with a single write. A later duplicate coordinate wins.
+    bool write_chunks(const ChunkWrite *writes, size_t count);
+
+    /// Fill `reads[i].data` for every stored coordinate. Payloads are read
+    /// in file order, and two payloads at most get_read_ahead() bytes apart
+    /// share one read (up to MAX_COALESCED_READ), so the gap is read
+    /// through instead of costing another seek. Returns the number found.
+    size_t read_chunks(ChunkRead *reads, size_t count) const;
+
+    /// Largest gap read through to join two payloads; 0 reads only
+    /// adjacent payloads together.
+    void set_read_ahead(uint64_t bytes);
+    uint64_t get_read_ahead() const;
+
+    bool remove_chunk(const ChunkCoord &c);
+
+    /// Make every write so far durable. No-op when nothing changed.
+    bool commit();
+
+    /// Whether there are writes or removals the next commit() would make
+    /// durable.
+    bool has_uncommitted() const;
+
+    /// Rewrite the live chunks, packed in Morton order, into "<path>.compact"
+    /// and atomically replace the file with it (VoxelFileIO::replace).
+    /// Installed but uncommitted writes are carried over and become durable.
+    /// Readers keep going while the copy is made; writers wait. Returns
+    /// false, leaving the file as it was, on I/O errors, or if a write was
+    /// installed or still in flight before the swap; it is then safe to
+    /// retry later.
+    bool compact();
+
+    void get_coords(std::vector<ChunkCoord> &out) const;
+    Stats get_stats() const;
+
+private:
+    struct Extent {
+        uint64_t sector = 0;
+        uint64_t count  = 0;
+    };
+
+    struct Entry {
+        ChunkCoord coord;
+        uint32_t   size = 0;
+        Extent     extent;                // empty for inline payloads
+        uint8_t    inline_data[INLINE_SIZE];
+    };
+
+    typedef std::unordered_map<ChunkCoord, Entry, ChunkCoordHash> EntryMap;
+
+    static uint64_t sectors_for(uint64_t bytes);
+    static void write_table_entry(uint8_t *p, const Entry &e);
+
+    bool initialize();
+    bool load();
+    bool load_table(const Header &h, uint64_t file_size);
+
+    Extent allocate(uint64_t count);
+    void release(const Extent &e);
+
+    mutable std::shared_mutex           lock;
+    VoxelFileIO                         file;
+    std::string                         path;
+    EntryMap                            entries;
+    std::map<uint64_t, uint64_t>        free_extents;     // first sector -> sector count
+    std::vector<Extent>                 pending_release;  // freed once the next commit lands
+    Extent                              table_extent;
+    uint64_t                            sequence = 0;     // of the header slot the file was opened at or last committed
+    uint64_t                            end_sector = HEADER_SECTORS;
+    bool                                dirty = false;
+    uint64_t                            generation = 0;   // bumped whenever `entries` changes
+    uint64_t                            epoch = 0;        // bumped whenever `file` is reopened, closed or swapped
+    uint32_t                            pending_writes = 0;  // extents allocated by write_chunks() and not yet installed
+    std::condition_variable_any         writes_done;      // notified when pending_writes drops
+    std::atomic<uint64_t>               read_ahead{ DEFAULT_READ_AHEAD };
+};
+
+} // namespace voxel_region
@@ -0,0 +1,170 @@
+// voxel_region_file.cpp
+
+#include "voxel_region_file.h"
+#include "voxel_codec.h"
+
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+#include <filesystem>
+#include <string.h>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+static inline voxel_region::ChunkCoord to_region_coord(const Vector3i &c) {
+    return voxel_region::ChunkCoord{ c.x, c.y, c.z };
+}
+
+// Reused across loads and saves on each thread; grows to the largest
+// payload seen.
+static thread_local std::vector<uint8_t> g_region_payload;
+static thread_local uint8_t              g_region_scratch_zxy[VoxelChunk::VOXEL_COUNT];
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelRegionFile::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("open", "path", "create"), &VoxelRegionFile::open, DEFVAL(true));
+    ClassDB::bind_method(D_METHOD("close"), &VoxelRegionFile::close);
+    ClassDB::bind_method(D_METHOD("is_open"), &VoxelRegionFile::is_open);
+
+    ClassDB::bind_method(D_METHOD("has_chunk", "coord"), &VoxelRegionFile::has_chunk);
+    ClassDB::bind_method(D_METHOD("save_chunk", "coord", "chunk"), &VoxelRegionFile::save_chunk);
+    ClassDB::bind_method(D_METHOD("load_chunk", "coord"), &VoxelRegionFile::load_chunk);
+    ClassDB::bind_method(D_METHOD("get_chunk_data", "coord"), &VoxelRegionFile::get_chunk_data);
+    ClassDB::bind_method(D_METHOD("remove_chunk", "coord"), &VoxelRegionFile::remove_chunk);
+    ClassDB::bind_method(D_METHOD("commit"), &VoxelRegionFile::commit);
+
+    ClassDB::bind_method(D_METHOD("set_codec_policy", "value"), &VoxelRegionFile::set_codec_policy);
+    ClassDB::bind_method(D_METHOD("get_codec_policy"), &VoxelRegionFile::get_codec_policy);
+
+    ClassDB::bind_method(D_METHOD("get_chunk_coords"), &VoxelRegionFile::get_chunk_coords);
+    ClassDB::bind_method(D_METHOD("get_chunk_count"), &VoxelRegionFile::get_chunk_count);
+    ClassDB::bind_method(D_METHOD("get_file_size"), &VoxelRegionFile::get_file_size);
+    ClassDB::bind_method(D_METHOD("get_free_bytes"), &VoxelRegionFile::get_free_bytes);
+}
+
+// -----------------------------------------------------------------------------
+// Opening
+// -----------------------------------------------------------------------------
+
+bool VoxelRegionFile::open(const String &path, bool create) {
+    const String global_path = ProjectSettings::get_singleton()->globalize_path(path);
+    const std::string utf8_path = global_path.utf8().get_data();
+
+    if (create) {
+        const std::filesystem::path file_path = std::filesystem::u8path(utf8_path);
+        if (file_path.has_parent_path()) {
+            std::error_code ec;
+            std::filesystem::create_directories(file_path.parent_path(), ec);
+        }
+    }
+    return region.open(utf8_path, create);
+}
+
+void VoxelRegionFile::close() {
+    region.close();
+}
+
+bool VoxelRegionFile::is_open() const {
+    return region.is_open();
+}
+
+// -----------------------------------------------------------------------------
+// Chunks
+// -----------------------------------------------------------------------------
+
+bool VoxelRegionFile::has_chunk(const Vector3i &coord) const {
+    return region.has_chunk(to_region_coord(coord));
+}
+
+bool VoxelRegionFile::save_chunk(const Vector3i &coord, const Ref<VoxelChunk> &chunk) {
+    ERR_FAIL_COND_V_MSG(chunk.is_null(), false, "save_chunk() needs a chunk.");
+    const voxel_codec::Policy policy = (voxel_codec::Policy)codec_policy.load(std::memory_order_relaxed);
+    chunk->unpack_materials_zxy(g_region_scratch_zxy);
+    voxel_codec::encode_auto(g_region_scratch_zxy, policy, g_region_payload);
+    if (chunk->unpack_flags_zxy(g_region_scratch_zxy)) {
+        voxel_codec::add_flags(g_region_scratch_zxy, policy, g_region_payload);
+    }
+    return region.write_chunk(to_region_coord(coord), g_region_payload.data(), g_region_payload.size());
+}
+
+Ref<VoxelChunk> VoxelRegionFile::load_chunk(const Vector3i &coord) const {
+    if (!region.read_chunk(to_region_coord(coord), g_region_payload)) {
+        return Ref<VoxelChunk>();
+    }
+    if (!voxel_codec::decode(g_region_payload.data(), g_region_payload.size(), g_region_scratch_zxy)) {
+        return Ref<VoxelChunk>();
+    }
+
+    Ref<VoxelChunk> chunk;
+    chunk.instantiate();
+    chunk->pack_materials_zxy(g_region_scratch_zxy);
+    if (voxel_codec::has_flags(g_region_payload.data(), g_region_payload.size())) {
+        if (!voxel_codec::decode_flags(g_region_payload.data(), g_region_payload.size(), g_region_scratch_zxy)) {
+            return Ref<VoxelChunk>();
+        }
+        chunk->pack_flags_zxy(g_region_scratch_zxy);
+    }
+    return chunk;
+}
+
+PackedByteArray VoxelRegionFile::get_chunk_data(const Vector3i &coord) const {
+    PackedByteArray out;
+    if (!region.read_chunk(to_region_coord(coord), g_region_payload)) {
+        return out;
+    }
+    out.resize(g_region_payload.size());
+    memcpy(out.ptrw(), g_region_payload.data(), g_region_payload.size());
+    return out;
+}
+
+bool VoxelRegionFile::remove_chunk(const Vector3i &coord) {
+    return region.remove_chunk(to_region_coord(coord));
+}
+
+bool VoxelRegionFile::commit() {
+    return region.commit();
+}
+
+void VoxelRegionFile::set_codec_policy(VoxelChunkCodec::Policy value) {
+    ERR_FAIL_COND_MSG(value < VoxelChunkCodec::POLICY_FASTEST || value > VoxelChunkCodec::POLICY_SMALLEST, "Unknown codec policy.");
+    codec_policy.store((int)value, std::memory_order_relaxed);
+}
+
+VoxelChunkCodec::Policy VoxelRegionFile::get_codec_policy() const {
+    return (VoxelChunkCodec::Policy)codec_policy.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Queries
+// -----------------------------------------------------------------------------
+
+TypedArray<Vector3i> VoxelRegionFile::get_chunk_coords() const {
+    std::vector<voxel_region::ChunkCoord> coords;
+    region.get_coords(coords);
+
+    TypedArray<Vector3i> out;
+    out.resize(coords.size());
+    for (size_t i = 0; i < coords.size(); ++i) {
+        out[i] = Vector3i(coords[i].x, coords[i].y, coords[i].z);
+    }
+    return out;
+}
+
+int VoxelRegionFile::get_chunk_count() const {
+    return (int)region.get_stats().chunk_count;
+}
+
+int64_t VoxelRegionFile::get_file_size() const {
+    return (int64_t)region.get_stats().file_bytes;
+}
+
+int64_t VoxelRegionFile::get_free_bytes() const {
+    return (int64_t)region.get_stats().free_bytes;
+}
@@ -0,0 +1,82 @@
+// voxel_region_file.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+#include <atomic>
+
+#include "voxel_chunk.h"
+#include "voxel_chunk_codec.h"
+#include "voxel_region.h"
+
+using namespace godot;
+
+/// A growable world save (voxel_region.h) from scripts.
+///
+/// Chunks are addressed by Vector3i chunk coordinates with no world size
+/// limit, stored as voxel_codec.h payloads with their flags (as
+/// VoxelStorage stores them, so its region files open here too), and
+/// written one at a time in place: saving N edited chunks costs N encodes
+/// and N positional writes, never a rewrite of the whole file. Writes become durable on commit(). Safe to
+/// use from several threads at once.
+///
+/// Untagged RLE payloads written before codecs existed still load. Generator
+/// diffs (CODEC_GENERATOR_DIFF) need the generator they were made against:
+/// load those through VoxelStorage.
+class VoxelRegionFile : public RefCounted {
+    GDCLASS(VoxelRegionFile, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    VoxelRegionFile() = default;
+    ~VoxelRegionFile() = default;
+
+    /// Open the file at `path` (res:// and user:// paths are accepted),
+    /// creating it and its directories if missing and `create` is set.
+    bool open(const String &path, bool create = true);
+
+    /// Close without committing.
+    void close();
+    bool is_open() const;
+
+    bool has_chunk(const Vector3i &coord) const;
+
+    /// Encode and store `chunk` under `coord`, replacing any previous data.
+    bool save_chunk(const Vector3i &coord, const Ref<VoxelChunk> &chunk);
+
+    /// The chunk stored under `coord`, decoded; null if missing, corrupt or
+    /// a generator diff.
+    Ref<VoxelChunk> load_chunk(const Vector3i &coord) const;
+
+    /// Copy of the stored payload (see VoxelChunkCodec); empty if there is
+    /// no chunk at `coord`.
+    PackedByteArray get_chunk_data(const Vector3i &coord) const;
+
+    /// How chunks are encoded from now on (VoxelChunkCodec::Policy).
+    /// Default POLICY_BALANCED. Chunks already stored keep their codec.
+    void set_codec_policy(VoxelChunkCodec::Policy value);
+    VoxelChunkCodec::Policy get_codec_policy() const;
+
+    bool remove_chunk(const Vector3i &coord);
+
+    /// Make all saves and removals so far durable.
+    bool commit();
+
+    TypedArray<Vector3i> get_chunk_coords() const;
+    int get_chunk_count() const;
+
+    /// Bytes spanned by allocated sectors, and how many of them are free
+    /// for reuse.
+    int64_t get_file_size() const;
+    int64_t get_free_bytes() const;
+
+private:
+    voxel_region::RegionFile region;
+    std::atomic<int>         codec_policy{ VoxelChunkCodec::POLICY_BALANCED };
+};
@@ -0,0 +1,585 @@
+// voxel_rle.cpp
+
+#include "voxel_rle.h"
+#include "voxel_bits.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VOXEL_RLE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace voxel_rle {
+
+// -----------------------------------------------------------------------------
+// Run detection
+// -----------------------------------------------------------------------------
+
+#ifdef VOXEL_RLE_SSE2
+// Bit i set if p[i] == value, for 64 bytes.
+static inline uint64_t equal_mask64(const uint8_t *p, __m128i value) {
+    const uint64_t m0 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 0)), value));
+    const uint64_t m1 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), value));
+    const uint64_t m2 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), value));
+    const uint64_t m3 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), value));
+    return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+}
+#endif
+
+size_t find_run_end(const uint8_t *src, size_t count, size_t start) {
+    const uint8_t value = src[start];
+    size_t i = start + 1;
+
+    // Eight bytes at a time first: XOR against the splatted value is zero
+    // while the run continues. Most runs in noisy chunks end here, before
+    // wide loads would pay off.
+    const uint64_t splat = 0x0101010101010101ull * value;
+    if (i + 8 <= count) {
+        uint64_t word;
+        memcpy(&word, src + i, 8);
+        const uint64_t differ = word ^ splat;
+        if (differ) {
+            // Little-endian: the lowest non-zero byte is the first mismatch.
+            return i + (voxel_bits::ctz64(differ) >> 3);
+        }
+        i += 8;
+    }
+
+#ifdef VOXEL_RLE_SSE2
+    const __m128i splat128 = _mm_set1_epi8((char)value);
+    while (i + 64 <= count) {
+        const uint64_t differ = ~equal_mask64(src + i, splat128);
+        if (differ) {
+            return i + voxel_bits::ctz64(differ);
+        }
+        i += 64;
+    }
+#endif
+
+    while (i + 8 <= count) {
+        uint64_t word;
+        memcpy(&word, src + i, 8);
+        const uint64_t differ = word ^ splat;
+        if (differ) {
+            return i + (voxel_bits::ctz64(differ) >> 3);
+        }
+        i += 8;
+    }
+
+    while (i < count && src[i] == value) {
+        ++i;
+    }
+    return i;
+}
+
+// -----------------------------------------------------------------------------
+// Format v1
+// -----------------------------------------------------------------------------
+
+size_t encode_v1(const uint8_t *src, size_t count, uint8_t *dst) {
+    uint8_t *out = dst;
+    size_t i = 0;
+
+    while (i < count) {
+        const uint8_t value = src[i];
+        const size_t  end   = find_run_end(src, count, i);
+        size_t length = end - i;
+        i = end;
+
+        while (length > V1_MAX_RUN) {
+            out[0] = value;
+            out[1] = V1_MAX_RUN;
+            out += 2;
+            length -= V1_MAX_RUN;
+        }
+        out[0] = value;
+        out[1] = (uint8_t)length;
+        out += 2;
+    }
+
+    return size_t(out - dst);
+}
+
+// -----------------------------------------------------------------------------
+// Format v2
+// -----------------------------------------------------------------------------
+
+static inline uint8_t *write_varint(uint8_t *out, size_t value) {
+    while (value >= 0x80) {
+        *out++ = uint8_t(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = uint8_t(value);
+    return out;
+}
+
+static inline bool read_varint(const uint8_t *&p, const uint8_t *end, size_t &value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 35; shift += 7) {
+        const uint8_t b = *p++;
+        value |= size_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t encode(const uint8_t *src, size_t count, uint8_t *dst) {
+    uint8_t *out = dst;
+    *out++ = 0xFF;
+    *out++ = 0x00;
+    *out++ = VERSION;
+
+    size_t i = 0;
+    while (i < count) {
+        const size_t end = find_run_end(src, count, i);
+        *out++ = src[i];
+        out = write_varint(out, end - i);
+        i = end;
+    }
+
+    return size_t(out - dst);
+}
+
+// -----------------------------------------------------------------------------
+// Scan orders
+// -----------------------------------------------------------------------------
+
+// ZXY index of position p along an order: each 6-bit digit of p (fastest
+// first) is one axis, weighted by that axis's ZXY stride.
+static constexpr int STRIDE_X = CHUNK_SIZE;
+static constexpr int STRIDE_Y = CHUNK_SIZE * CHUNK_SIZE;
+static constexpr int STRIDE_Z = 1;
+
+static constexpr int ORDER_STRIDES[ORDER_MORTON][3] = {
+    { STRIDE_Z, STRIDE_X, STRIDE_Y },   // ORDER_ZXY
+    { STRIDE_X, STRIDE_Y, STRIDE_Z },   // ORDER_XYZ
+    { STRIDE_Y, STRIDE_X, STRIDE_Z },   // ORDER_YXZ
+};
+
+// Morton code m -> ZXY index, as three lookups of 6 bits (two bits per axis)
+// each: index = part[0][m & 63] + part[1][(m >> 6) & 63] + part[2][m >> 12].
+struct MortonTable {
+    uint32_t part[3][64];
+
+    MortonTable() {
+        for (int level = 0; level < 3; ++level) {
+            for (int digit = 0; digit < 64; ++digit) {
+                int x = 0, y = 0, z = 0;
+                for (int bit = 0; bit < 2; ++bit) {
+                    x |= ((digit >> (bit * 3 + 0)) & 1) << (level * 2 + bit);
+                    y |= ((digit >> (bit * 3 + 1)) & 1) << (level * 2 + bit);
+                    z |= ((digit >> (bit * 3 + 2)) & 1) << (level * 2 + bit);
+                }
+                part[level][digit] = uint32_t(z * STRIDE_Z + x * STRIDE_X + y * STRIDE_Y);
+            }
+        }
+    }
+
+    inline uint32_t index(uint32_t m) const {
+        return part[0][m & 63] + part[1][(m >> 6) & 63] + part[2][m >> 12];
+    }
+};
+
+static const MortonTable g_morton;
+
+// Reorder a ZXY chunk into `order`.
+static void gather(const uint8_t *src_zxy, Order order, uint8_t *dst) {
+    if (order == ORDER_MORTON) {
+        for (uint32_t m = 0; m < (uint32_t)CHUNK_VOLUME; ++m) {
+            dst[m] = src_zxy[g_morton.index(m)];
+        }
+        return;
+    }
+
+    const int *s = ORDER_STRIDES[order];
+    for (int c = 0; c < CHUNK_SIZE; ++c) {
+        for (int b = 0; b < CHUNK_SIZE; ++b) {
+            const uint8_t *row = src_zxy + b * s[1] + c * s[2];
+            for (int a = 0; a < CHUNK_SIZE; ++a) {
+                *dst++ = row[a * s[0]];
+            }
+        }
+    }
+}
+
+static size_t encode_runs_v3(const uint8_t *ordered, Order order, uint8_t *dst) {
+    uint8_t *out = dst;
+    *out++ = 0xFF;
+    *out++ = 0x00;
+    *out++ = CHUNK_VERSION;
+    *out++ = order;
+
+    size_t i = 0;
+    while (i < (size_t)CHUNK_VOLUME) {
+        const size_t end = find_run_end(ordered, CHUNK_VOLUME, i);
+        *out++ = ordered[i];
+        out = write_varint(out, end - i);
+        i = end;
+    }
+
+    return size_t(out - dst);
+}
+
+// Per-thread scratch for the reordered chunk and the candidate stream.
+static thread_local uint8_t g_rle_ordered[CHUNK_VOLUME];
+static thread_local uint8_t g_rle_candidate[max_encoded_chunk_size()];
+
+size_t encode_chunk(const uint8_t *src_zxy, uint8_t *dst, Order order) {
+    if (order != ORDER_AUTO) {
+        const uint8_t *ordered = src_zxy;
+        if (order != ORDER_ZXY) {
+            gather(src_zxy, order, g_rle_ordered);
+            ordered = g_rle_ordered;
+        }
+        return encode_runs_v3(ordered, order, dst);
+    }
+
+    size_t best = encode_runs_v3(src_zxy, ORDER_ZXY, dst);
+    for (int o = ORDER_ZXY + 1; o < ORDER_COUNT; ++o) {
+        gather(src_zxy, (Order)o, g_rle_ordered);
+        const size_t size = encode_runs_v3(g_rle_ordered, (Order)o, g_rle_candidate);
+        if (size < best) {
+            memcpy(dst, g_rle_candidate, size);
+            best = size;
+        }
+    }
+    return best;
+}
+
+int get_version(const uint8_t *src, size_t size) {
+    if (size >= V2_HEADER_SIZE && src[0] == 0xFF && src[1] == 0x00) {
+        if (src[2] == VERSION) {
+            return VERSION;
+        }
+        if (src[2] == CHUNK_VERSION && size >= V3_HEADER_SIZE && src[3] < ORDER_COUNT) {
+            return CHUNK_VERSION;
+        }
+        return 0;
+    }
+    return 1;
+}
+
+Order get_order(const uint8_t *src, size_t size) {
+    return get_version(src, size) == CHUNK_VERSION ? (Order)src[3] : ORDER_ZXY;
+}
+
+// -----------------------------------------------------------------------------
+// Decoding
+// -----------------------------------------------------------------------------
+
+// Set bits [pos, pos + length) of a bit array, whole words in the middle.
+static inline void set_bit_range(uint64_t *mask, size_t pos, size_t length) {
+    const size_t end   = pos + length;
+    const size_t first = pos >> 6;
+    const size_t last  = (end - 1) >> 6;
+    const uint64_t head = ~0ull << (pos & 63);
+    const uint64_t tail = ~0ull >> (63 - ((end - 1) & 63));
+
+    if (first == last) {
+        mask[first] |= head & tail;
+        return;
+    }
+    mask[first] |= head;
+    for (size_t w = first + 1; w < last; ++w) {
+        mask[w] = ~0ull;
+    }
+    mask[last] |= tail;
+}
+
+// Run sinks: write(pos, material, length) stores one run that starts at
+// position `pos` of the stream's scan order.
+
+template <bool OPAQUE>
+struct LinearWriter {
+    uint8_t  *dst;
+    uint64_t *opaque_mask;
+
+    inline void write(size_t pos, uint8_t material, size_t length) const {
+        memset(dst + pos, material, length);
+        if (OPAQUE && material != 0) {
+            set_bit_range(opaque_mask, pos, length);
+        }
+    }
+};
+
+// Linear orders other than ZXY: split the run at rows of the fastest axis
+// and store each row with that axis's stride.
+template <bool OPAQUE>
+struct StridedWriter {
+    uint8_t   *dst;
+    uint64_t  *opaque_mask;
+    const int *stride;
+
+    inline void write(size_t pos, uint8_t material, size_t length) const {
+        while (length > 0) {
+            const int a = int(pos & 63);
+            const int b = int((pos >> 6) & 63);
+            const int c = int(pos >> 12);
+            const size_t n = length < size_t(CHUNK_SIZE - a) ? length : size_t(CHUNK_SIZE - a);
+
+            size_t index = size_t(a * stride[0] + b * stride[1] + c * stride[2]);
+            for (size_t k = 0; k < n; ++k, index += stride[0]) {
+                dst[index] = material;
+                if (OPAQUE && material != 0) {
+                    opaque_mask[index >> 6] |= 1ull << (index & 63);
+                }
+            }
+            pos    += n;
+            length -= n;
+        }
+    }
+};
+
+template <bool OPAQUE>
+struct MortonWriter {
+    uint8_t  *dst;
+    uint64_t *opaque_mask;
+
+    inline void write(size_t pos, uint8_t material, size_t length) const {
+        for (size_t m = pos; m < pos + length; ++m) {
+            const uint32_t index = g_morton.index(uint32_t(m));
+            dst[index] = material;
+            if (OPAQUE && material != 0) {
+                opaque_mask[index >> 6] |= 1ull << (index & 63);
+            }
+        }
+    }
+};
+
+template <int FORMAT, typename Writer>
+static bool decode_runs(const uint8_t *p, const uint8_t *end, size_t count, const Writer &writer) {
+    size_t pos = 0;
+
+    while (p < end) {
+        uint8_t material;
+        size_t  length;
+        if (FORMAT == 1) {
+            if (end - p < 2) {
+                return false;
+            }
+            material = p[0];
+            length   = p[1];
+            p += 2;
+        } else {
+            material = *p++;
+            if (!read_varint(p, end, length)) {
+                return false;
+            }
+        }
+
+        if (length == 0) {
+            continue;
+        }
+        if (length > count - pos) {
+            return false;
+        }
+
+        writer.write(pos, material, length);
+        pos += length;
+    }
+
+    return pos == count;
+}
+
+template <bool OPAQUE>
+static bool decode_any(const uint8_t *src, size_t size, uint8_t *dst, size_t count, uint64_t *opaque_mask) {
+    const LinearWriter<OPAQUE> linear = { dst, opaque_mask };
+
+    switch (get_version(src, size)) {
+        case 1:
+            return decode_runs<1>(src, src + size, count, linear);
+        case VERSION:
+            return decode_runs<2>(src + V2_HEADER_SIZE, src + size, count, linear);
+        case CHUNK_VERSION: {
+            if (count != (size_t)CHUNK_VOLUME) {
+                return false;
+            }
+            const uint8_t *runs = src + V3_HEADER_SIZE;
+            const Order order = (Order)src[3];
+            if (order == ORDER_ZXY) {
+                return decode_runs<3>(runs, src + size, count, linear);
+            }
+            if (order == ORDER_MORTON) {
+                const MortonWriter<OPAQUE> morton = { dst, opaque_mask };
+                return decode_runs<3>(runs, src + size, count, morton);
+            }
+            const StridedWriter<OPAQUE> strided = { dst, opaque_mask, ORDER_STRIDES[order] };
+            return decode_runs<3>(runs, src + size, count, strided);
+        }
+        default:
+            return false;
+    }
+}
+
+bool decode(const uint8_t *src, size_t size, uint8_t *dst, size_t count) {
+    return decode_any<false>(src, size, dst, count, nullptr);
+}
+
+bool decode_opaque(const uint8_t *src, size_t size, uint8_t *dst, size_t count, uint64_t *opaque_mask) {
+    memset(opaque_mask, 0, (count / 64) * sizeof(uint64_t));
+    return decode_any<true>(src, size, dst, count, opaque_mask);
+}
+
+// -----------------------------------------------------------------------------
+// Random access
+// -----------------------------------------------------------------------------
+
+// Where a stream's runs start and how they are coded (v1 pairs or varints).
+static inline bool stream_layout(const uint8_t *src, size_t size, size_t &runs_offset, bool &pairs) {
+    switch (get_version(src, size)) {
+        case 1:
+            runs_offset = 0;
+            pairs       = true;
+            return true;
+        case VERSION:
+            runs_offset = V2_HEADER_SIZE;
+            pairs       = false;
+            return true;
+        case CHUNK_VERSION:
+            runs_offset = V3_HEADER_SIZE;
+            pairs       = false;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static inline bool read_run(bool pairs, const uint8_t *&p, const uint8_t *end, uint8_t &material, size_t &length) {
+    if (pairs) {
+        if (end - p < 2) {
+            return false;
+        }
+        material = p[0];
+        length   = p[1];
+        p += 2;
+        return true;
+    }
+    material = *p++;
+    return read_varint(p, end, length);
+}
+
+bool build_index(const uint8_t *src, size_t size, size_t count, std::vector<IndexEntry> &out) {
+    out.clear();
+
+    size_t runs_offset;
+    bool   pairs;
+    if (!stream_layout(src, size, runs_offset, pairs) || size > UINT32_MAX || count > UINT32_MAX) {
+        return false;
+    }
+
+    const uint8_t *p   = src + runs_offset;
+    const uint8_t *end = src + size;
+    size_t pos  = 0;
+    int    runs = 0;
+
+    while (p < end) {
+        const uint8_t *run = p;
+        uint8_t material;
+        size_t  length;
+        if (!read_run(pairs, p, end, material, length) || length > count - pos) {
+            out.clear();
+            return false;
+        }
+        if (length == 0) {
+            continue;
+        }
+        if (runs++ % INDEX_RUN_STRIDE == 0) {
+            out.push_back({ uint32_t(run - src), uint32_t(pos) });
+        }
+        pos += length;
+    }
+
+    if (pos != count) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+// Last index entry starting at or before `pos`.
+static inline const IndexEntry &find_entry(const std::vector<IndexEntry> &index, size_t pos) {
+    size_t lo = 0;
+    size_t hi = index.size();
+    while (hi - lo > 1) {
+        const size_t mid = (lo + hi) / 2;
+        if (index[mid].position <= pos) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return index[lo];
+}
+
+void read_range(const uint8_t *src, size_t size, const std::vector<IndexEntry> &index,
+        size_t pos, size_t length, uint8_t *dst) {
+    if (length == 0) {
+        return;
+    }
+
+    size_t runs_offset = 0;
+    bool   pairs       = false;
+    if (index.empty() || !stream_layout(src, size, runs_offset, pairs)) {
+        memset(dst, 0, length);
+        return;
+    }
+
+    const IndexEntry &entry = find_entry(index, pos);
+    const uint8_t *p   = src + entry.offset;
+    const uint8_t *end = src + size;
+    size_t run_start = entry.position;
+
+    while (length > 0 && p < end) {
+        uint8_t material   = 0;
+        size_t  run_length = 0;
+        if (!read_run(pairs, p, end, material, run_length)) {
+            break;
+        }
+
+        const size_t run_end = run_start + run_length;
+        if (run_end > pos) {
+            const size_t n = run_end - pos < length ? run_end - pos : length;
+            memset(dst, material, n);
+            dst    += n;
+            pos    += n;
+            length -= n;
+        }
+        run_start = run_end;
+    }
+
+    // Truncated or malformed stream: what it does not cover reads as air.
+    if (length > 0) {
+        memset(dst, 0, length);
+    }
+}
+
+uint8_t read_at(const uint8_t *src, size_t size, const std::vector<IndexEntry> &index, size_t pos) {
+    uint8_t value = 0;
+    read_range(src, size, index, pos, 1, &value);
+    return value;
+}
+
+uint32_t order_position(Order order, int x, int y, int z) {
+    switch (order) {
+        case ORDER_XYZ:
+            return uint32_t(x + y * CHUNK_SIZE + z * CHUNK_SIZE * CHUNK_SIZE);
+        case ORDER_YXZ:
+            return uint32_t(y + x * CHUNK_SIZE + z * CHUNK_SIZE * CHUNK_SIZE);
+        case ORDER_MORTON: {
+            uint32_t m = 0;
+            for (int bit = 0; bit < 6; ++bit) {
+                m |= uint32_t((x >> bit) & 1) << (bit * 3 + 0);
+                m |= uint32_t((y >> bit) & 1) << (bit * 3 + 1);
+                m |= uint32_t((z >> bit) & 1) << (bit * 3 + 2);
+            }
+            return m;
+        }
+        default:
+            return uint32_t(z + x * CHUNK_SIZE + y * CHUNK_SIZE * CHUNK_SIZE);
+    }
+}
+
+} // namespace voxel_rle
@@ -0,0 +1,130 @@
+// voxel_rle.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/// Run-length coding of voxel bytes.
+///
+/// Format v1 is the cgerikj_rle.h format: (material, length) byte pairs with
+/// 1 <= length <= 255. The encoder here produces the same pairs as
+/// rle::compress, except for the (0, 0) pair rle::compress starts with when
+/// the first byte is not 0 (decoders skip it). It finds run ends with one
+/// 8-byte probe, then 64 bytes at a time with SSE2 compares, and writes into
+/// a caller-sized buffer with no per-run allocation or recursion.
+///
+/// Format v2 starts with the header (0xFF, 0x00, version), a pair v1 never
+/// emits, followed by (material, LEB128 length) runs, so a run of any length
+/// costs 2-4 bytes: an all-air chunk is 7 bytes instead of 2,058.
+///
+/// Format v3 is v2 for whole 64^3 chunks with a fourth header byte naming
+/// the scan order the runs follow. encode_chunk() tries every order and
+/// keeps the smallest stream. Generated terrain is mostly best in ZXY itself,
+/// since layers of constant y are already long runs; XYZ wins on some cave
+/// and layered chunks, and y-first orders rarely win. Decoders write each
+/// order straight into the ZXY layout, without a transpose, and accept all
+/// three formats.
+namespace voxel_rle {
+
+static constexpr int     V1_MAX_RUN     = 255;
+static constexpr uint8_t VERSION        = 2;   // written by encode()
+static constexpr uint8_t CHUNK_VERSION  = 3;   // written by encode_chunk()
+static constexpr int     V2_HEADER_SIZE = 3;
+static constexpr int     V3_HEADER_SIZE = 4;
+
+static constexpr int CHUNK_SIZE   = 64;
+static constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+/// Scan orders of a v3 chunk, fastest axis first. ZXY is the storage and
+/// mesher layout; v1 and v2 chunk streams are always ZXY.
+enum Order : uint8_t {
+    ORDER_ZXY,
+    ORDER_XYZ,
+    ORDER_YXZ,
+    ORDER_MORTON,   // 3D Z-order curve, x in the lowest bit
+    ORDER_COUNT,
+    ORDER_AUTO = 0xFF,
+};
+
+/// Upper bound on encode_v1() output for `count` voxels.
+static constexpr size_t max_encoded_size_v1(size_t count) {
+    return count * 2;
+}
+
+/// Index of the first byte at or after `start` that differs from
+/// src[start], or `count` if the run reaches the end.
+size_t find_run_end(const uint8_t *src, size_t count, size_t start);
+
+/// Encode `count` bytes into `dst` (at least max_encoded_size_v1(count)
+/// bytes). Returns the number of bytes written.
+size_t encode_v1(const uint8_t *src, size_t count, uint8_t *dst);
+
+/// Upper bound on encode() output for `count` voxels.
+static constexpr size_t max_encoded_size(size_t count) {
+    return V2_HEADER_SIZE + count * 2;
+}
+
+/// Encode `count` bytes as the current format (v2) into `dst` (at least
+/// max_encoded_size(count) bytes). Returns the number of bytes written.
+size_t encode(const uint8_t *src, size_t count, uint8_t *dst);
+
+/// Upper bound on encode_chunk() output.
+static constexpr size_t max_encoded_chunk_size() {
+    return V3_HEADER_SIZE + CHUNK_VOLUME * 2;
+}
+
+/// Encode a 64^3 ZXY chunk as v3 in `order`, or in whichever order gives
+/// the smallest stream for ORDER_AUTO (ties go to ZXY, the cheapest to
+/// decode). `dst` needs max_encoded_chunk_size() bytes.
+size_t encode_chunk(const uint8_t *src_zxy, uint8_t *dst, Order order = ORDER_AUTO);
+
+/// Format of an encoded stream: 1, 2, 3, or 0 if the header names a version
+/// this build cannot read.
+int get_version(const uint8_t *src, size_t size);
+
+/// Scan order of a chunk stream (ORDER_ZXY for v1 and v2).
+Order get_order(const uint8_t *src, size_t size);
+
+/// Decode a stream of any supported version into exactly `count` bytes.
+/// Returns false if it is malformed or does not cover `count` exactly.
+/// v3 streams are chunks: `count` must be CHUNK_VOLUME and `dst` is ZXY.
+bool decode(const uint8_t *src, size_t size, uint8_t *dst, size_t count);
+
+/// decode() that also writes the opaque mask of the decoded bytes: bit i of
+/// word i / 64 is set where dst[i] != 0 (for a ZXY chunk, the meshers'
+/// y*64 + x column layout). Solid runs set whole words at a time. `count`
+/// must be a multiple of 64.
+bool decode_opaque(const uint8_t *src, size_t size, uint8_t *dst, size_t count, uint64_t *opaque_mask);
+
+// --- Random access ---
+
+/// Sparse run index: one entry every INDEX_RUN_STRIDE runs, so a lookup is
+/// a binary search over the entries plus a scan of at most that many runs.
+/// Its size follows the run count, not the voxel count: an all-air chunk
+/// has a single entry.
+static constexpr int INDEX_RUN_STRIDE = 16;
+
+struct IndexEntry {
+    uint32_t offset;     // byte offset of the run in the stream
+    uint32_t position;   // decoded position the run starts at
+};
+
+/// Build the index of a stream of any version. Returns false, leaving
+/// `out` empty, if the stream is malformed or does not decode to `count`.
+bool build_index(const uint8_t *src, size_t size, size_t count, std::vector<IndexEntry> &out);
+
+/// Copy decoded positions [pos, pos + length) of an indexed stream to
+/// `dst`, in stream order. The range must lie inside the decoded size.
+/// Positions a malformed stream does not cover are written as 0.
+void read_range(const uint8_t *src, size_t size, const std::vector<IndexEntry> &index,
+        size_t pos, size_t length, uint8_t *dst);
+
+/// Decoded value at stream position `pos`.
+uint8_t read_at(const uint8_t *src, size_t size, const std::vector<IndexEntry> &index, size_t pos);
+
+/// Stream position of chunk voxel (x, y, z) in a chunk encoded in `order`.
+uint32_t order_position(Order order, int x, int y, int z);
+
+} // namespace voxel_rle
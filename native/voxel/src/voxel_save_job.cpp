@@ -0,0 +1,111 @@
+// voxel_save_job.cpp
+
+#include "voxel_save_job.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelSaveJob::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("get_task_count"), &VoxelSaveJob::get_task_count);
+    ClassDB::bind_method(D_METHOD("get_chunk_count"), &VoxelSaveJob::get_chunk_count);
+    ClassDB::bind_method(D_METHOD("run_task", "index"), &VoxelSaveJob::run_task);
+    ClassDB::bind_method(D_METHOD("run"), &VoxelSaveJob::run);
+    ClassDB::bind_method(D_METHOD("is_done"), &VoxelSaveJob::is_done);
+    ClassDB::bind_method(D_METHOD("finish"), &VoxelSaveJob::finish);
+}
+
+// -----------------------------------------------------------------------------
+// Setup
+// -----------------------------------------------------------------------------
+
+void VoxelSaveJob::add_chunk(const Vector3i &region, const Vector3i &coord, const Ref<VoxelChunk> &chunk) {
+    // Batches are few (one per region) and filled in world order, so the
+    // last one is nearly always the right one.
+    RegionBatch *batch = nullptr;
+    for (size_t i = batches.size(); i-- > 0;) {
+        if (batches[i].region == region) {
+            batch = &batches[i];
+            break;
+        }
+    }
+    if (batch == nullptr) {
+        batches.push_back(RegionBatch());
+        batch = &batches.back();
+        batch->region = region;
+    }
+
+    batch->coords.push_back(coord);
+    batch->chunks.push_back(chunk);
+    ++chunk_count;
+}
+
+void VoxelSaveJob::seal() {
+    states.reset(new std::atomic<uint8_t>[batches.size()]);
+    for (size_t i = 0; i < batches.size(); ++i) {
+        states[i].store(TASK_PENDING, std::memory_order_relaxed);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Running
+// -----------------------------------------------------------------------------
+
+int VoxelSaveJob::get_task_count() const {
+    return (int)batches.size();
+}
+
+int VoxelSaveJob::get_chunk_count() const {
+    return chunk_count;
+}
+
+void VoxelSaveJob::run_task(int index) {
+    ERR_FAIL_INDEX_MSG(index, (int)batches.size(), "Save task index out of range.");
+
+    uint8_t expected = TASK_PENDING;
+    ERR_FAIL_COND_MSG(!states[index].compare_exchange_strong(expected, TASK_RUNNING, std::memory_order_acq_rel),
+            "Save task already ran.");
+
+    RegionBatch &batch = batches[index];
+    const bool ok = storage.is_valid()
+            && storage->write_region(batch.region, batch.coords.data(), batch.chunks.data(), batch.coords.size(), true,
+                    sequence);
+
+    // Drop the snapshots so later edits of the live chunks need not copy.
+    std::vector<Ref<VoxelChunk>>().swap(batch.chunks);
+
+    states[index].store(ok ? TASK_SAVED : TASK_FAILED, std::memory_order_release);
+    completed.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void VoxelSaveJob::run() {
+    for (int i = 0; i < (int)batches.size(); ++i) {
+        run_task(i);
+    }
+}
+
+bool VoxelSaveJob::is_done() const {
+    return completed.load(std::memory_order_acquire) == (int)batches.size();
+}
+
+bool VoxelSaveJob::finish() {
+    ERR_FAIL_COND_V_MSG(!is_done(), false, "finish() called before every save task ran.");
+
+    bool ok = true;
+    for (size_t i = 0; i < batches.size(); ++i) {
+        if (states[i].load(std::memory_order_acquire) == TASK_SAVED) {
+            continue;
+        }
+        ok = false;
+        if (world.is_valid()) {
+            for (const Vector3i &coord : batches[i].coords) {
+                world->mark_chunk_unsaved(coord);
+            }
+        }
+    }
+    return ok;
+}
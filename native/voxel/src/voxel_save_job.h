@@ -0,0 +1,90 @@
+// voxel_save_job.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "voxel_chunk.h"
+#include "voxel_storage.h"
+#include "voxel_world.h"
+
+using namespace godot;
+
+/// A world save captured at one instant and written later, off the thread
+/// that owns the world.
+///
+/// VoxelStorage::begin_save() drains the world's unsaved list and snapshots
+/// each chunk (VoxelChunk::snapshot: refcount bumps, no voxel copies),
+/// grouped by region. run_task() then encodes, writes and commits one
+/// region, and may be called from any thread, e.g.
+///   WorkerThreadPool.add_group_task(job.run_task, job.get_task_count())
+/// while gameplay keeps editing the live chunks; the first edit to a
+/// snapshotted chunk copies its data. Call finish() from the world's
+/// thread once every task has run.
+///
+/// Jobs may overlap. A region already written by a later save (a later
+/// begin_save() or a direct save_chunk()) rejects this job's batch, and
+/// finish() marks those chunks unsaved again rather than letting the older
+/// snapshot win.
+///
+/// The storage's generator is used unsnapshotted: leave its settings alone
+/// until the job is done (see VoxelStorage::set_generator).
+class VoxelSaveJob : public RefCounted {
+    GDCLASS(VoxelSaveJob, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    VoxelSaveJob() = default;
+    ~VoxelSaveJob() = default;
+
+    /// One task per region touched by the save.
+    int get_task_count() const;
+    int get_chunk_count() const;
+
+    /// Save region `index`. Each index must run exactly once.
+    void run_task(int index);
+
+    /// Run every task on the calling thread.
+    void run();
+
+    bool is_done() const;
+
+    /// Re-mark the chunks of failed regions as unsaved in the world so the
+    /// next save retries them. Returns true if every region was saved.
+    bool finish();
+
+private:
+    friend class VoxelStorage;
+
+    enum TaskState : uint8_t {
+        TASK_PENDING,
+        TASK_RUNNING,
+        TASK_SAVED,
+        TASK_FAILED,
+    };
+
+    struct RegionBatch {
+        Vector3i                     region;
+        std::vector<Vector3i>        coords;
+        std::vector<Ref<VoxelChunk>> chunks;   // snapshots, dropped once written
+    };
+
+    void add_chunk(const Vector3i &region, const Vector3i &coord, const Ref<VoxelChunk> &chunk);
+
+    /// Called once all chunks are added; sizes the task state array.
+    void seal();
+
+    Ref<VoxelStorage>                      storage;
+    Ref<VoxelWorld>                        world;
+    std::vector<RegionBatch>               batches;
+    std::unique_ptr<std::atomic<uint8_t>[]> states;
+    std::atomic<int>                       completed{ 0 };
+    int                                    chunk_count = 0;
+    uint64_t                               sequence = 0;   // VoxelStorage::next_save_sequence() at snapshot time
+};
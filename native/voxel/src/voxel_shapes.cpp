@@ -0,0 +1,320 @@
+// voxel_shapes.cpp
+
+#include "voxel_shapes.h"
+#include "voxel_bits.h"
+#include "voxel_noise.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace voxel_shapes {
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+struct Interval {
+    double lo = 0.0;
+    double hi = -1.0;
+    bool is_empty() const { return hi < lo; }
+};
+
+static inline Interval make_interval(double lo, double hi) {
+    Interval out;
+    out.lo = lo;
+    out.hi = hi;
+    return out;
+}
+
+static inline Interval intersect(const Interval &a, const Interval &b) {
+    return make_interval(a.lo > b.lo ? a.lo : b.lo, a.hi < b.hi ? a.hi : b.hi);
+}
+
+// Smallest interval covering both (the pieces of a convex shape overlap).
+static inline Interval envelope(const Interval &a, const Interval &b) {
+    if (a.is_empty()) return b;
+    if (b.is_empty()) return a;
+    return make_interval(a.lo < b.lo ? a.lo : b.lo, a.hi > b.hi ? a.hi : b.hi);
+}
+
+// Column (px, py, t) against a sphere of radius r at the origin.
+static inline Interval sphere_interval(double px, double py, double r) {
+    const double rem = r * r - px * px - py * py;
+    if (rem < 0.0) {
+        return Interval();
+    }
+    const double h = sqrt(rem);
+    return make_interval(-h, h);
+}
+
+// Column (px, py, t) against a capped cylinder from the origin to `d`.
+static Interval cylinder_interval(double px, double py, const double d[3], double r) {
+    const double l2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    if (l2 <= 0.0) {
+        return Interval();
+    }
+
+    // Projection onto the axis: paba(t) = k + t*dz must lie in [0, l2].
+    const double k = px * d[0] + py * d[1];
+    Interval caps;
+    if (fabs(d[2]) < 1e-12) {
+        if (k < 0.0 || k > l2) {
+            return Interval();
+        }
+        caps = make_interval(-INFINITY, INFINITY);
+    } else {
+        const double t0 = -k / d[2];
+        const double t1 = (l2 - k) / d[2];
+        caps = t0 < t1 ? make_interval(t0, t1) : make_interval(t1, t0);
+    }
+
+    // Radial distance: l2*|pa|^2 - paba^2 <= r^2*l2 is a quadratic in t.
+    const double qa = l2 - d[2] * d[2];
+    const double qb = -2.0 * k * d[2];
+    const double qc = l2 * (px * px + py * py) - k * k - r * r * l2;
+
+    Interval radial;
+    if (qa < 1e-12 * l2) {
+        // Axis parallel to z: the radial distance does not depend on t.
+        if (qc > 0.0) {
+            return Interval();
+        }
+        radial = make_interval(-INFINITY, INFINITY);
+    } else {
+        const double disc = qb * qb - 4.0 * qa * qc;
+        if (disc < 0.0) {
+            return Interval();
+        }
+        const double s = sqrt(disc);
+        radial = make_interval((-qb - s) / (2.0 * qa), (-qb + s) / (2.0 * qa));
+    }
+
+    return intersect(caps, radial);
+}
+
+// Bits lo..hi inclusive (0 <= lo, hi <= 63).
+static inline uint64_t bit_range(int lo, int hi) {
+    if (hi < lo) {
+        return 0;
+    }
+    const int n = hi - lo + 1;
+    return (n >= 64 ? ~0ull : ((1ull << n) - 1)) << lo;
+}
+
+// Interval of t (voxel centre z relative to the shape anchor, t = oz + z)
+// to a column mask clipped to [z_lo, z_hi).
+static inline uint64_t interval_to_mask(const Interval &iv, double oz, int z_lo, int z_hi) {
+    if (iv.is_empty()) {
+        return 0;
+    }
+    const double zf0 = ceil(iv.lo - oz);
+    const double zf1 = floor(iv.hi - oz);
+    if (zf0 >= z_hi || zf1 < z_lo) {
+        return 0;
+    }
+    const int z0 = zf0 < z_lo ? z_lo : (int)zf0;
+    const int z1 = zf1 > z_hi - 1 ? z_hi - 1 : (int)zf1;
+    return bit_range(z0, z1);
+}
+
+using voxel_bits::clz64;
+using voxel_bits::ctz64;
+
+// Spread 8 mask bits into 8 bytes of 0x00 / 0xFF.
+static inline uint64_t expand_byte_mask(uint64_t bits8) {
+    uint64_t m = (bits8 * 0x0101010101010101ull) & 0x8040201008040201ull;
+    m = ((m + 0x7F7F7F7F7F7F7F7Full) | m) & 0x8080808080808080ull;
+    return (m >> 7) * 0xFF;
+}
+
+// -----------------------------------------------------------------------------
+// Bounds
+// -----------------------------------------------------------------------------
+
+void get_bounds(const Shape &shape, int out_min[3], int out_max[3]) {
+    double lo[3];
+    double hi[3];
+
+    for (int i = 0; i < 3; ++i) {
+        switch (shape.type) {
+            case SHAPE_SPHERE:
+                lo[i] = shape.a[i] - shape.radius;
+                hi[i] = shape.a[i] + shape.radius;
+                break;
+            case SHAPE_NOISE_SPHERE:
+                lo[i] = shape.a[i] - shape.radius - fabs(shape.noise_amplitude);
+                hi[i] = shape.a[i] + shape.radius + fabs(shape.noise_amplitude);
+                break;
+            case SHAPE_BOX:
+                lo[i] = shape.a[i] - shape.b[i];
+                hi[i] = shape.a[i] + shape.b[i];
+                break;
+            case SHAPE_CAPSULE:
+            case SHAPE_CYLINDER:
+                lo[i] = (shape.a[i] < shape.b[i] ? shape.a[i] : shape.b[i]) - shape.radius;
+                hi[i] = (shape.a[i] > shape.b[i] ? shape.a[i] : shape.b[i]) + shape.radius;
+                break;
+        }
+        out_min[i] = (int)floor(lo[i]);
+        out_max[i] = (int)floor(hi[i]) + 1;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Rasterization
+// -----------------------------------------------------------------------------
+
+bool rasterize(const Shape &shape, const int origin[3], const int lo[3], const int hi[3], uint64_t *column_masks) {
+    // Voxel centres relative to the shape anchor `a`.
+    const double ox = origin[0] + 0.5 - shape.a[0];
+    const double oy = origin[1] + 0.5 - shape.a[1];
+    const double oz = origin[2] + 0.5 - shape.a[2];
+
+    // Second end point relative to `a` (capsule / cylinder).
+    const double d[3] = { shape.b[0] - shape.a[0], shape.b[1] - shape.a[1], shape.b[2] - shape.a[2] };
+
+    const double noise_amp   = fabs(shape.noise_amplitude);
+    const double inner_r     = shape.radius - noise_amp;
+
+    uint64_t any = 0;
+
+    for (int y = lo[1]; y < hi[1]; ++y) {
+        const double py = oy + y;
+
+        for (int x = lo[0]; x < hi[0]; ++x) {
+            const double px = ox + x;
+            uint64_t mask = 0;
+
+            switch (shape.type) {
+                case SHAPE_SPHERE:
+                    mask = interval_to_mask(sphere_interval(px, py, shape.radius), oz, lo[2], hi[2]);
+                    break;
+
+                case SHAPE_BOX:
+                    if (fabs(px) <= shape.b[0] && fabs(py) <= shape.b[1]) {
+                        mask = interval_to_mask(make_interval(-shape.b[2], shape.b[2]), oz, lo[2], hi[2]);
+                    }
+                    break;
+
+                case SHAPE_CYLINDER:
+                    mask = interval_to_mask(cylinder_interval(px, py, d, shape.radius), oz, lo[2], hi[2]);
+                    break;
+
+                case SHAPE_CAPSULE: {
+                    Interval iv = cylinder_interval(px, py, d, shape.radius);
+                    iv = envelope(iv, sphere_interval(px, py, shape.radius));
+                    Interval end_b = sphere_interval(px - d[0], py - d[1], shape.radius);
+                    if (!end_b.is_empty()) {
+                        end_b.lo += d[2];
+                        end_b.hi += d[2];
+                    }
+                    mask = interval_to_mask(envelope(iv, end_b), oz, lo[2], hi[2]);
+                } break;
+
+                case SHAPE_NOISE_SPHERE: {
+                    const uint64_t outer = interval_to_mask(sphere_interval(px, py, shape.radius + noise_amp), oz, lo[2], hi[2]);
+                    if (outer == 0) {
+                        break;
+                    }
+                    const uint64_t inner = inner_r > 0.0
+                        ? interval_to_mask(sphere_interval(px, py, inner_r), oz, lo[2], hi[2])
+                        : 0;
+
+                    // Only the shell between the two spheres needs the noise.
+                    mask = inner;
+                    uint64_t shell = outer & ~inner;
+                    const float wx = float(origin[0] + x) + 0.5f;
+                    const float wy = float(origin[1] + y) + 0.5f;
+                    while (shell) {
+                        const int z = ctz64(shell);
+                        shell &= shell - 1;
+
+                        const double pz   = oz + z;
+                        const double dist = sqrt(px * px + py * py + pz * pz);
+                        const float  wz   = float(origin[2] + z) + 0.5f;
+                        const float  n    = voxel_noise::perlin3(wx * shape.noise_frequency, wy * shape.noise_frequency,
+                                wz * shape.noise_frequency, shape.seed);
+                        if (dist <= shape.radius + shape.noise_amplitude * n) {
+                            mask |= 1ull << z;
+                        }
+                    }
+                } break;
+            }
+
+            column_masks[y * SIZE + x] = mask;
+            any |= mask;
+        }
+    }
+
+    return any != 0;
+}
+
+// -----------------------------------------------------------------------------
+// Apply
+// -----------------------------------------------------------------------------
+
+bool apply_masks(const uint64_t *column_masks, const int lo[3], const int hi[3], uint8_t material,
+        uint8_t *voxels_zxy, int dirty_min[3], int dirty_max[3]) {
+    const uint64_t pattern = uint64_t(material) * 0x0101010101010101ull;
+    bool changed = false;
+
+    for (int y = lo[1]; y < hi[1]; ++y) {
+        for (int x = lo[0]; x < hi[0]; ++x) {
+            const uint64_t mask = column_masks[y * SIZE + x];
+            if (mask == 0) {
+                continue;
+            }
+
+            // The column is 64 contiguous bytes (z fastest): 8 voxels per word.
+            uint8_t *row = voxels_zxy + x * SIZE + y * SIZE * SIZE;
+            int first = SIZE;
+            int last  = -1;
+
+            for (int g = 0; g < 8; ++g) {
+                const uint64_t bits8 = (mask >> (g * 8)) & 0xFF;
+                if (bits8 == 0) {
+                    continue;
+                }
+                const uint64_t select = expand_byte_mask(bits8);
+
+                uint64_t old_word;
+                memcpy(&old_word, row + g * 8, 8);
+                const uint64_t new_word = (old_word & ~select) | (pattern & select);
+                const uint64_t diff     = old_word ^ new_word;
+                if (diff == 0) {
+                    continue;
+                }
+                memcpy(row + g * 8, &new_word, 8);
+
+                // Byte order within the word follows memory order on little endian.
+                const int lo_z = g * 8 + ctz64(diff) / 8;
+                const int hi_z = g * 8 + (63 - clz64(diff)) / 8;
+                if (lo_z < first) first = lo_z;
+                if (hi_z > last)  last  = hi_z;
+            }
+
+            if (last < 0) {
+                continue;
+            }
+
+            if (!changed) {
+                dirty_min[0] = dirty_max[0] = x;
+                dirty_min[1] = dirty_max[1] = y;
+                dirty_min[2] = first;
+                dirty_max[2] = last;
+                changed = true;
+            } else {
+                if (x < dirty_min[0]) dirty_min[0] = x;
+                if (x > dirty_max[0]) dirty_max[0] = x;
+                if (y < dirty_min[1]) dirty_min[1] = y;
+                if (y > dirty_max[1]) dirty_max[1] = y;
+                if (first < dirty_min[2]) dirty_min[2] = first;
+                if (last  > dirty_max[2]) dirty_max[2] = last;
+            }
+        }
+    }
+
+    return changed;
+}
+
+} // namespace voxel_shapes
@@ -0,0 +1,565 @@
+// voxel_storage.cpp
+
+#include "voxel_storage.h"
+#include "voxel_codec.h"
+#include "voxel_save_job.h"
+
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+static inline int floor_div(int v, int d) {
+    return (v >= 0) ? (v / d) : -((-v + d - 1) / d);
+}
+
+static inline voxel_region::ChunkCoord to_region_coord(const Vector3i &c) {
+    return voxel_region::ChunkCoord{ c.x, c.y, c.z };
+}
+
+// Reused across loads on each thread; grows to the largest payload seen.
+static thread_local std::vector<uint8_t> g_storage_payload;
+static thread_local uint8_t              g_storage_scratch_zxy[VoxelChunk::VOXEL_COUNT];
+static thread_local uint8_t              g_storage_base_zxy[VoxelChunk::VOXEL_COUNT];
+static thread_local uint8_t              g_storage_flags_zxy[VoxelChunk::VOXEL_COUNT];
+
+// A new chunk from a stored payload; null if it is corrupt. Generator
+// diffs are replayed on top of what `generator` makes at `coord`.
+static Ref<VoxelChunk> decode_payload(const uint8_t *data, size_t size, const Vector3i &coord,
+        const VoxelTerrainGenerator *generator) {
+    const uint8_t *base = nullptr;
+    uint32_t base_key = 0;
+    if (voxel_codec::get_diff_base_key(data, size, base_key)) {
+        ERR_FAIL_COND_V_MSG(generator == nullptr, Ref<VoxelChunk>(),
+                "Chunk is stored as a generator diff, but the storage has no generator.");
+        ERR_FAIL_COND_V_MSG(base_key != (uint32_t)generator->get_settings_hash(), Ref<VoxelChunk>(),
+                "Chunk was saved as a diff against a generator with different settings.");
+        generator->generate_zxy(coord, g_storage_base_zxy);
+        base = g_storage_base_zxy;
+    }
+
+    if (!voxel_codec::decode(data, size, g_storage_scratch_zxy, base)) {
+        return Ref<VoxelChunk>();
+    }
+    Ref<VoxelChunk> chunk;
+    chunk.instantiate();
+    chunk->pack_materials_zxy(g_storage_scratch_zxy);
+    if (voxel_codec::has_flags(data, size)) {
+        if (!voxel_codec::decode_flags(data, size, g_storage_flags_zxy)) {
+            return Ref<VoxelChunk>();
+        }
+        chunk->pack_flags_zxy(g_storage_flags_zxy);
+    }
+    return chunk;
+}
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelStorage::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("open", "directory"), &VoxelStorage::open);
+    ClassDB::bind_method(D_METHOD("close"), &VoxelStorage::close);
+    ClassDB::bind_method(D_METHOD("is_open"), &VoxelStorage::is_open);
+
+    ClassDB::bind_static_method("VoxelStorage", D_METHOD("get_region_coord", "coord"), &VoxelStorage::get_region_coord);
+
+    ClassDB::bind_method(D_METHOD("has_chunk", "coord"), &VoxelStorage::has_chunk);
+    ClassDB::bind_method(D_METHOD("save_chunk", "coord", "chunk"), &VoxelStorage::save_chunk);
+    ClassDB::bind_method(D_METHOD("load_chunk", "coord"), &VoxelStorage::load_chunk);
+    ClassDB::bind_method(D_METHOD("get_chunk_data", "coord"), &VoxelStorage::get_chunk_data);
+    ClassDB::bind_method(D_METHOD("remove_chunk", "coord"), &VoxelStorage::remove_chunk);
+    ClassDB::bind_method(D_METHOD("save_chunks", "coords", "chunks"), &VoxelStorage::save_chunks);
+    ClassDB::bind_method(D_METHOD("load_chunks", "coords"), &VoxelStorage::load_chunks);
+    ClassDB::bind_method(D_METHOD("set_read_ahead", "bytes"), &VoxelStorage::set_read_ahead);
+    ClassDB::bind_method(D_METHOD("get_read_ahead"), &VoxelStorage::get_read_ahead);
+    ClassDB::bind_method(D_METHOD("set_codec_policy", "value"), &VoxelStorage::set_codec_policy);
+    ClassDB::bind_method(D_METHOD("get_codec_policy"), &VoxelStorage::get_codec_policy);
+    ClassDB::bind_method(D_METHOD("set_generator", "value"), &VoxelStorage::set_generator);
+    ClassDB::bind_method(D_METHOD("get_generator"), &VoxelStorage::get_generator);
+
+    ClassDB::bind_method(D_METHOD("save_world", "world"), &VoxelStorage::save_world);
+    ClassDB::bind_method(D_METHOD("begin_save", "world"), &VoxelStorage::begin_save);
+    ClassDB::bind_method(D_METHOD("commit"), &VoxelStorage::commit);
+    ClassDB::bind_method(D_METHOD("commit_region", "region_coord"), &VoxelStorage::commit_region);
+
+    ClassDB::bind_method(D_METHOD("set_compaction_threshold", "value"), &VoxelStorage::set_compaction_threshold);
+    ClassDB::bind_method(D_METHOD("get_compaction_threshold"), &VoxelStorage::get_compaction_threshold);
+    ClassDB::bind_method(D_METHOD("compact_fragmented"), &VoxelStorage::compact_fragmented);
+
+    ClassDB::bind_method(D_METHOD("get_chunk_coords"), &VoxelStorage::get_chunk_coords);
+    ClassDB::bind_method(D_METHOD("get_open_region_count"), &VoxelStorage::get_open_region_count);
+    ClassDB::bind_method(D_METHOD("set_max_open_regions", "value"), &VoxelStorage::set_max_open_regions);
+    ClassDB::bind_method(D_METHOD("get_max_open_regions"), &VoxelStorage::get_max_open_regions);
+}
+
+// -----------------------------------------------------------------------------
+// Opening
+// -----------------------------------------------------------------------------
+
+bool VoxelStorage::open(const String &p_directory) {
+    const String global_path = ProjectSettings::get_singleton()->globalize_path(p_directory);
+    const std::string utf8_path = global_path.utf8().get_data();
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::u8path(utf8_path), ec);
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    regions.clear();
+    directory.clear();
+    if (!std::filesystem::is_directory(std::filesystem::u8path(utf8_path), ec)) {
+        return false;
+    }
+    directory = utf8_path;
+    return true;
+}
+
+void VoxelStorage::close() {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    regions.clear();
+    directory.clear();
+}
+
+bool VoxelStorage::is_open() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return !directory.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Regions
+// -----------------------------------------------------------------------------
+
+Vector3i VoxelStorage::get_region_coord(const Vector3i &coord) {
+    return Vector3i(floor_div(coord.x, REGION_SIZE), floor_div(coord.y, REGION_SIZE), floor_div(coord.z, REGION_SIZE));
+}
+
+std::string VoxelStorage::region_path(const Vector3i &region_coord) const {
+    char name[64];
+    snprintf(name, sizeof(name), "r.%d.%d.%d.vxr", region_coord.x, region_coord.y, region_coord.z);
+    return (std::filesystem::u8path(directory) / name).u8string();
+}
+
+VoxelStorage::RegionRef VoxelStorage::get_region(const Vector3i &region_coord, bool create) const {
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        if (directory.empty()) {
+            return nullptr;
+        }
+        auto it = regions.find(region_coord);
+        if (it != regions.end() && (!create || it->second.file->is_open())) {
+            it->second.last_use.store(region_clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return it->second.file;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    if (directory.empty()) {
+        return nullptr;
+    }
+    OpenRegion &entry = regions[region_coord];
+    entry.last_use.store(region_clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    const RegionRef region = entry.file ? entry.file : std::make_shared<voxel_region::RegionFile>();
+    if (!entry.file) {
+        entry.file = region;
+        region->set_read_ahead((uint64_t)read_ahead.load(std::memory_order_relaxed));
+        region->open(region_path(region_coord), false);
+        evict_regions((size_t)max_open_regions.load(std::memory_order_relaxed));
+    }
+    if (create && !region->is_open()) {
+        region->open(region_path(region_coord), true);
+    }
+    return region;
+}
+
+void VoxelStorage::evict_regions(size_t max_open) const {
+    if (regions.size() <= max_open) {
+        return;
+    }
+
+    // Only the map holds an idle region, so no call can be using it, and
+    // none can pick it up again while `lock` is held.
+    std::vector<std::pair<uint64_t, Vector3i>> idle;
+    for (const auto &kv : regions) {
+        if (kv.second.file.use_count() == 1 && !kv.second.file->has_uncommitted()) {
+            idle.emplace_back(kv.second.last_use.load(std::memory_order_relaxed), kv.first);
+        }
+    }
+    const size_t count = std::min(idle.size(), regions.size() - max_open);
+    std::partial_sort(idle.begin(), idle.begin() + count, idle.end(),
+            [](const std::pair<uint64_t, Vector3i> &a, const std::pair<uint64_t, Vector3i> &b) { return a.first < b.first; });
+    for (size_t i = 0; i < count; ++i) {
+        regions.erase(idle[i].second);
+    }
+}
+
+void VoxelStorage::get_open_regions(std::vector<RegionRef> &out) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    out.clear();
+    out.reserve(regions.size());
+    for (const auto &kv : regions) {
+        out.push_back(kv.second.file);
+    }
+}
+
+bool VoxelStorage::commit() {
+    std::vector<RegionRef> open_regions;
+    get_open_regions(open_regions);
+
+    bool ok = true;
+    for (const RegionRef &region : open_regions) {
+        if (region->is_open()) {
+            ok = region->commit() && ok;
+        }
+    }
+    open_regions.clear();
+
+    // Regions kept open past the cap only for their uncommitted writes can
+    // go now.
+    std::unique_lock<std::shared_mutex> guard(lock);
+    evict_regions((size_t)max_open_regions.load(std::memory_order_relaxed));
+    return ok;
+}
+
+bool VoxelStorage::commit_region(const Vector3i &region_coord) {
+    const RegionRef region = get_region(region_coord, false);
+    return region != nullptr && (!region->is_open() || region->commit());
+}
+
+void VoxelStorage::set_compaction_threshold(float value) {
+    compaction_threshold.store(value, std::memory_order_relaxed);
+}
+
+float VoxelStorage::get_compaction_threshold() const {
+    return compaction_threshold.load(std::memory_order_relaxed);
+}
+
+int VoxelStorage::compact_fragmented() {
+    std::vector<RegionRef> open_regions;
+    get_open_regions(open_regions);
+
+    const double threshold = compaction_threshold.load(std::memory_order_relaxed);
+    int compacted = 0;
+    for (const RegionRef &region : open_regions) {
+        if (!region->is_open()) {
+            continue;
+        }
+        const voxel_region::Stats stats = region->get_stats();
+        if ((int64_t)stats.file_bytes >= COMPACTION_MIN_BYTES && stats.get_fragmentation() >= threshold && region->compact()) {
+            ++compacted;
+        }
+    }
+    return compacted;
+}
+
+int VoxelStorage::get_open_region_count() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    int count = 0;
+    for (const auto &kv : regions) {
+        count += kv.second.file->is_open() ? 1 : 0;
+    }
+    return count;
+}
+
+void VoxelStorage::set_max_open_regions(int value) {
+    ERR_FAIL_COND_MSG(value < 1, "At least one region must be allowed open.");
+    max_open_regions.store(value, std::memory_order_relaxed);
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    evict_regions((size_t)value);
+}
+
+int VoxelStorage::get_max_open_regions() const {
+    return max_open_regions.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Chunks
+// -----------------------------------------------------------------------------
+
+bool VoxelStorage::has_chunk(const Vector3i &coord) const {
+    const RegionRef region = get_region(get_region_coord(coord), false);
+    return region != nullptr && region->has_chunk(to_region_coord(coord));
+}
+
+bool VoxelStorage::save_chunk(const Vector3i &coord, const Ref<VoxelChunk> &chunk) {
+    ERR_FAIL_COND_V_MSG(chunk.is_null(), false, "save_chunk() needs a chunk.");
+    return write_region(get_region_coord(coord), &coord, &chunk, 1, false, next_save_sequence());
+}
+
+Ref<VoxelChunk> VoxelStorage::load_chunk(const Vector3i &coord) const {
+    const RegionRef region = get_region(get_region_coord(coord), false);
+    if (region == nullptr) {
+        return Ref<VoxelChunk>();
+    }
+
+    const Ref<VoxelTerrainGenerator> gen = get_generator();
+    if (!region->read_chunk(to_region_coord(coord), g_storage_payload)) {
+        return gen.is_valid() ? gen->generate_chunk(coord) : Ref<VoxelChunk>();
+    }
+    return decode_payload(g_storage_payload.data(), g_storage_payload.size(), coord, gen.ptr());
+}
+
+PackedByteArray VoxelStorage::get_chunk_data(const Vector3i &coord) const {
+    PackedByteArray out;
+    const RegionRef region = get_region(get_region_coord(coord), false);
+    if (region == nullptr || !region->read_chunk(to_region_coord(coord), g_storage_payload)) {
+        return out;
+    }
+    out.resize(g_storage_payload.size());
+    memcpy(out.ptrw(), g_storage_payload.data(), g_storage_payload.size());
+    return out;
+}
+
+bool VoxelStorage::remove_chunk(const Vector3i &coord) {
+    const RegionRef region = get_region(get_region_coord(coord), false);
+    return region != nullptr && region->remove_chunk(to_region_coord(coord));
+}
+
+bool VoxelStorage::save_chunks(const TypedArray<Vector3i> &coords, const Array &chunks) {
+    ERR_FAIL_COND_V_MSG(coords.size() != chunks.size(), false, "save_chunks() needs one chunk per coordinate.");
+
+    struct Batch {
+        std::vector<Vector3i>        coords;
+        std::vector<Ref<VoxelChunk>> chunks;
+    };
+    std::unordered_map<Vector3i, Batch, RegionCoordHash> by_region;
+    for (int64_t i = 0; i < coords.size(); ++i) {
+        const Ref<VoxelChunk> chunk = chunks[i];
+        if (chunk.is_null()) {
+            continue;
+        }
+        const Vector3i coord = coords[i];
+        Batch &batch = by_region[get_region_coord(coord)];
+        batch.coords.push_back(coord);
+        batch.chunks.push_back(chunk);
+    }
+
+    const uint64_t sequence = next_save_sequence();
+    bool ok = true;
+    for (const auto &kv : by_region) {
+        ok = write_region(kv.first, kv.second.coords.data(), kv.second.chunks.data(), kv.second.coords.size(), false, sequence) && ok;
+    }
+    return ok;
+}
+
+uint64_t VoxelStorage::next_save_sequence() {
+    return save_sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+std::shared_ptr<VoxelStorage::RegionSaveState> VoxelStorage::get_save_state(const Vector3i &region_coord) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    std::shared_ptr<RegionSaveState> &state = save_states[region_coord];
+    if (!state) {
+        state = std::make_shared<RegionSaveState>();
+    }
+    return state;
+}
+
+bool VoxelStorage::write_region(const Vector3i &region_coord, const Vector3i *coords, const Ref<VoxelChunk> *chunks,
+        size_t count, bool commit, uint64_t sequence) {
+    const voxel_codec::Policy policy = (voxel_codec::Policy)codec_policy.load(std::memory_order_relaxed);
+    const Ref<VoxelTerrainGenerator> gen = get_generator();
+    const uint32_t base_key = gen.is_valid() ? (uint32_t)gen->get_settings_hash() : 0;
+
+    std::vector<std::vector<uint8_t>> payloads(count);
+    std::vector<voxel_region::ChunkWrite> writes;
+    std::vector<voxel_region::ChunkCoord> unchanged;   // identical to the generator: stored as nothing
+    writes.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const voxel_region::ChunkCoord c = to_region_coord(coords[i]);
+        chunks[i]->unpack_materials_zxy(g_storage_scratch_zxy);
+        const bool flagged = chunks[i]->unpack_flags_zxy(g_storage_flags_zxy);
+
+        if (gen.is_valid()) {
+            // The generator sets no flags, so a flagged chunk always differs.
+            gen->generate_zxy(coords[i], g_storage_base_zxy);
+            if (!flagged && memcmp(g_storage_scratch_zxy, g_storage_base_zxy, VoxelChunk::VOXEL_COUNT) == 0) {
+                unchanged.push_back(c);
+                continue;
+            }
+            // A chunk rebuilt from scratch can be cheaper to store whole.
+            voxel_codec::encode_diff(g_storage_scratch_zxy, g_storage_base_zxy, base_key, policy, payloads[i]);
+            voxel_codec::encode_auto(g_storage_scratch_zxy, policy, g_storage_payload);
+            if (g_storage_payload.size() < payloads[i].size()) {
+                payloads[i].swap(g_storage_payload);
+            }
+        } else {
+            voxel_codec::encode_auto(g_storage_scratch_zxy, policy, payloads[i]);
+        }
+        if (flagged) {
+            voxel_codec::add_flags(g_storage_flags_zxy, policy, payloads[i]);
+        }
+        writes.push_back(voxel_region::ChunkWrite{ c, payloads[i].data(), payloads[i].size() });
+    }
+
+    // Encoding above runs in parallel; writing is one save at a time per
+    // region, and never older data over newer.
+    const std::shared_ptr<RegionSaveState> state = get_save_state(region_coord);
+    std::lock_guard<std::mutex> save_guard(state->lock);
+    if (sequence < state->sequence) {
+        return false;
+    }
+    state->sequence = sequence;
+
+    // Only chunks with data create a region file.
+    const RegionRef region = get_region(region_coord, !writes.empty());
+    if (region == nullptr) {
+        return false;
+    }
+
+    bool ok = writes.empty() || region->write_chunks(writes.data(), writes.size());
+    for (const voxel_region::ChunkCoord &c : unchanged) {
+        if (region->has_chunk(c)) {
+            ok = region->remove_chunk(c) && ok;
+        }
+    }
+    return ok && (!commit || !region->is_open() || region->commit());
+}
+
+Array VoxelStorage::load_chunks(const TypedArray<Vector3i> &coords) const {
+    const int64_t count = coords.size();
+    Array out;
+    out.resize(count);
+
+    std::unordered_map<Vector3i, std::vector<int64_t>, RegionCoordHash> by_region;
+    for (int64_t i = 0; i < count; ++i) {
+        by_region[get_region_coord(coords[i])].push_back(i);
+    }
+
+    const Ref<VoxelTerrainGenerator> gen = get_generator();
+    std::vector<voxel_region::ChunkRead> reads;
+    for (const auto &kv : by_region) {
+        const RegionRef region = get_region(kv.first, false);
+        if (region == nullptr) {
+            return out;
+        }
+
+        reads.resize(kv.second.size());
+        for (size_t k = 0; k < kv.second.size(); ++k) {
+            reads[k].coord = to_region_coord(coords[kv.second[k]]);
+        }
+        region->read_chunks(reads.data(), reads.size());
+
+        for (size_t k = 0; k < kv.second.size(); ++k) {
+            const int64_t  i     = kv.second[k];
+            const Vector3i coord = coords[i];
+            if (!reads[k].found) {
+                if (gen.is_valid()) {
+                    out[i] = gen->generate_chunk(coord);
+                }
+                continue;
+            }
+            const Ref<VoxelChunk> chunk = decode_payload(reads[k].data.data(), reads[k].data.size(), coord, gen.ptr());
+            if (chunk.is_valid()) {
+                out[i] = chunk;
+            }
+        }
+    }
+    return out;
+}
+
+void VoxelStorage::set_read_ahead(int64_t bytes) {
+    ERR_FAIL_COND_MSG(bytes < 0, "Read-ahead must not be negative.");
+    read_ahead.store(bytes, std::memory_order_relaxed);
+
+    std::shared_lock<std::shared_mutex> guard(lock);
+    for (const auto &kv : regions) {
+        kv.second.file->set_read_ahead((uint64_t)bytes);
+    }
+}
+
+int64_t VoxelStorage::get_read_ahead() const {
+    return read_ahead.load(std::memory_order_relaxed);
+}
+
+void VoxelStorage::set_codec_policy(VoxelChunkCodec::Policy value) {
+    ERR_FAIL_COND_MSG(value < VoxelChunkCodec::POLICY_FASTEST || value > VoxelChunkCodec::POLICY_SMALLEST, "Unknown codec policy.");
+    codec_policy.store((int)value, std::memory_order_relaxed);
+}
+
+VoxelChunkCodec::Policy VoxelStorage::get_codec_policy() const {
+    return (VoxelChunkCodec::Policy)codec_policy.load(std::memory_order_relaxed);
+}
+
+void VoxelStorage::set_generator(const Ref<VoxelTerrainGenerator> &value) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    generator = value;
+}
+
+Ref<VoxelTerrainGenerator> VoxelStorage::get_generator() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return generator;
+}
+
+bool VoxelStorage::save_world(const Ref<VoxelWorld> &world) {
+    const Ref<VoxelSaveJob> job = begin_save(world);
+    if (job.is_null()) {
+        return false;
+    }
+    job->run();
+    return job->finish();
+}
+
+Ref<VoxelSaveJob> VoxelStorage::begin_save(const Ref<VoxelWorld> &world) {
+    ERR_FAIL_COND_V_MSG(world.is_null(), Ref<VoxelSaveJob>(), "begin_save() needs a world.");
+
+    Ref<VoxelSaveJob> job;
+    job.instantiate();
+    job->storage  = Ref<VoxelStorage>(this);
+    job->world    = world;
+    job->sequence = next_save_sequence();
+
+    const TypedArray<Vector3i> unsaved = world->take_unsaved_chunks();
+    for (int64_t i = 0; i < unsaved.size(); ++i) {
+        const Vector3i coord = unsaved[i];
+        const Ref<VoxelChunk> chunk = world->get_chunk(coord);
+        if (chunk.is_valid()) {
+            job->add_chunk(get_region_coord(coord), coord, chunk->snapshot());
+        }
+    }
+    job->seal();
+    return job;
+}
+
+TypedArray<Vector3i> VoxelStorage::get_chunk_coords() const {
+    TypedArray<Vector3i> out;
+
+    std::string dir;
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        dir = directory;
+    }
+    if (dir.empty()) {
+        return out;
+    }
+
+    std::error_code ec;
+    std::vector<voxel_region::ChunkCoord> coords;
+    for (const auto &item : std::filesystem::directory_iterator(std::filesystem::u8path(dir), ec)) {
+        Vector3i rc;
+        char tail = 0;
+        if (sscanf(item.path().filename().u8string().c_str(), "r.%d.%d.%d.vx%c", &rc.x, &rc.y, &rc.z, &tail) != 4 || tail != 'r') {
+            continue;
+        }
+
+        const RegionRef region = get_region(rc, false);
+        if (region == nullptr) {
+            continue;
+        }
+        region->get_coords(coords);
+        for (const voxel_region::ChunkCoord &c : coords) {
+            out.push_back(Vector3i(c.x, c.y, c.z));
+        }
+    }
+    return out;
+}
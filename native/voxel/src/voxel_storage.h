@@ -0,0 +1,249 @@
+// voxel_storage.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "voxel_chunk.h"
+#include "voxel_chunk_codec.h"
+#include "voxel_region.h"
+#include "voxel_terrain_generator.h"
+#include "voxel_world.h"
+
+using namespace godot;
+
+class VoxelSaveJob;
+
+/// A world save split into region files of REGION_SIZE^3 chunks.
+///
+/// Each region is its own voxel_region::RegionFile ("r.<x>.<y>.<z>.vxr" in
+/// the save directory) with its own table, free list and lock, opened on
+/// first use. Past get_max_open_regions() the least recently used regions
+/// that are idle and fully committed are closed again. Load and save workers touching different regions never
+/// contend beyond a brief shared lock on the region map, and a commit or a
+/// crash mid-save only ever affects the regions that were being written.
+///
+/// save_chunks() and load_chunks() are the batched paths for streaming: a
+/// batch is written in Morton order so spatial neighbours end up adjacent
+/// on disk, and a neighbourhood load becomes a few coalesced reads per
+/// region instead of one seek per chunk.
+///
+/// save_world() is the incremental save: it writes only the chunks the
+/// world reports as edited, then commits (one sync per touched region).
+/// begin_save() splits the same save in two: a cheap copy-on-write
+/// snapshot on the world's thread and a VoxelSaveJob that encodes and
+/// writes on worker threads, one region per task, while editing goes on.
+/// Space left behind by rewritten chunks is reused by later saves; once a
+/// region's fragmentation crosses the compaction threshold,
+/// compact_fragmented() rewrites it. Run that on a worker thread: it locks
+/// one region at a time, and readers of that region are not blocked.
+///
+/// Chunk payloads are voxel_codec.h payloads, tagged with their codec; the
+/// codec policy decides per chunk how hard a save works to shrink it.
+/// Chunks with per-voxel flags set carry them in a flags record.
+///
+/// With a generator set, the save only holds what players changed: a chunk
+/// identical to the generator's output (materials, and no flags set) is not
+/// stored (and dropped if an
+/// older save stored it), any other chunk is stored as its diff against
+/// that output when that is smaller, and loads regenerate the terrain and
+/// replay the diff on top. Chunks with no stored data load as freshly
+/// generated ones. Diffs carry the generator's settings hash; loading one
+/// with a differently configured generator fails rather than corrupting it.
+class VoxelStorage : public RefCounted {
+    GDCLASS(VoxelStorage, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    /// Chunks per region along each axis.
+    static constexpr int REGION_SIZE = 32;
+
+    /// Regions smaller than this are never worth compacting.
+    static constexpr int64_t COMPACTION_MIN_BYTES = 1024 * 1024;
+
+    /// Default for set_max_open_regions(): a streaming radius of a few
+    /// regions, well below common file descriptor limits.
+    static constexpr int DEFAULT_MAX_OPEN_REGIONS = 64;
+
+    VoxelStorage() = default;
+    ~VoxelStorage() = default;
+
+    /// Use `directory` (res:// and user:// paths are accepted) as the save,
+    /// creating it if needed. Closes any previously open save.
+    bool open(const String &directory);
+
+    /// Close every region without committing. Calls already running on
+    /// other threads finish on the regions they hold, which close once the
+    /// last of them returns.
+    void close();
+    bool is_open() const;
+
+    /// Region holding chunk `coord` (floor division by REGION_SIZE).
+    static Vector3i get_region_coord(const Vector3i &coord);
+
+    /// Whether data is stored for `coord`. With a generator that means the
+    /// chunk differs from the generated terrain.
+    bool has_chunk(const Vector3i &coord) const;
+
+    /// Encode and store `chunk` under `coord`, replacing any previous data.
+    bool save_chunk(const Vector3i &coord, const Ref<VoxelChunk> &chunk);
+
+    /// The chunk stored under `coord`, decoded; null if corrupt, or if
+    /// missing and there is no generator to make it.
+    Ref<VoxelChunk> load_chunk(const Vector3i &coord) const;
+
+    /// Copy of the stored payload (see VoxelChunkCodec); empty if there is
+    /// no chunk at `coord`.
+    PackedByteArray get_chunk_data(const Vector3i &coord) const;
+
+    bool remove_chunk(const Vector3i &coord);
+
+    /// Encode and store chunks[i] under coords[i], one batched write per
+    /// region. Null chunks are skipped.
+    bool save_chunks(const TypedArray<Vector3i> &coords, const Array &chunks);
+
+    /// The chunks stored under `coords`, decoded, in the same order (null
+    /// where load_chunk() would return null), read with coalesced I/O per
+    /// region.
+    Array load_chunks(const TypedArray<Vector3i> &coords) const;
+
+    /// Largest gap between two requested payloads that load_chunks() reads
+    /// through rather than seeking over (voxel_region::RegionFile::
+    /// set_read_ahead). Size it to the streaming radius: larger radii leave
+    /// fewer holes between the chunks they request.
+    void set_read_ahead(int64_t bytes);
+    int64_t get_read_ahead() const;
+
+    /// How chunks are encoded from now on (VoxelChunkCodec::Policy).
+    /// Default POLICY_BALANCED. Chunks already stored keep their codec.
+    void set_codec_policy(VoxelChunkCodec::Policy value);
+    VoxelChunkCodec::Policy get_codec_policy() const;
+
+    /// Generator that saved chunks are diffed against and missing chunks
+    /// are generated with; null (the default) stores every chunk whole.
+    /// Usually the world's own generator. Set it before saving or loading,
+    /// and keep its settings: they are part of the save. Save workers
+    /// (VoxelSaveJob tasks) generate with it and read its settings hash, so
+    /// neither the generator nor its settings may change while a
+    /// begin_save() job is running.
+    void set_generator(const Ref<VoxelTerrainGenerator> &value);
+    Ref<VoxelTerrainGenerator> get_generator() const;
+
+    /// Save every chunk of `world` edited since the last save
+    /// (VoxelWorld::take_unsaved_chunks) and commit. Chunks unloaded since
+    /// their edit are skipped. On failure the chunks stay marked unsaved.
+    bool save_world(const Ref<VoxelWorld> &world);
+
+    /// Snapshot the chunks save_world() would write and return the job
+    /// that writes them (see VoxelSaveJob). Call from the world's thread.
+    Ref<VoxelSaveJob> begin_save(const Ref<VoxelWorld> &world);
+
+    /// Commit every open region. Returns false if any region failed; the
+    /// others are still committed.
+    bool commit();
+
+    /// Commit a single region.
+    bool commit_region(const Vector3i &region_coord);
+
+    /// Free share of a region file (0..1) at or above which
+    /// compact_fragmented() rewrites it. Default 0.5.
+    void set_compaction_threshold(float value);
+    float get_compaction_threshold() const;
+
+    /// Compact every open region at or above the threshold (and at least
+    /// COMPACTION_MIN_BYTES). Returns the number of regions rewritten.
+    int compact_fragmented();
+
+    /// Coordinates of all stored chunks. Opens every region file in the
+    /// save directory.
+    TypedArray<Vector3i> get_chunk_coords() const;
+
+    /// Regions currently open.
+    int get_open_region_count() const;
+
+    /// Regions kept open at most. Opening another closes the least recently
+    /// used ones that no call is using and that have nothing uncommitted;
+    /// regions with uncommitted writes stay open (over the cap if need be)
+    /// until commit() runs. Default DEFAULT_MAX_OPEN_REGIONS.
+    void set_max_open_regions(int value);
+    int get_max_open_regions() const;
+
+    // --- Native access (not bound) ---
+
+    /// Encode chunks[i] and store it under coords[i], all of which lie in
+    /// `region_coord`, as one batch (diffed against the generator, if any);
+    /// then commit the region if `commit`. `sequence` (next_save_sequence(),
+    /// taken when the chunk data was captured) orders saves: writes to one
+    /// region run one at a time, and one older than the region's last save
+    /// fails without writing, so its chunks are retried from live data.
+    bool write_region(const Vector3i &region_coord, const Vector3i *coords, const Ref<VoxelChunk> *chunks,
+            size_t count, bool commit, uint64_t sequence);
+
+    /// A save sequence number later than every one handed out before.
+    uint64_t next_save_sequence();
+
+private:
+    struct RegionCoordHash {
+        size_t operator()(const Vector3i &c) const {
+            return voxel_region::ChunkCoordHash()(voxel_region::ChunkCoord{ c.x, c.y, c.z });
+        }
+    };
+
+    /// Shared so a caller keeps its region alive after dropping `lock`, even
+    /// if close(), open() or eviction drops it from the map meanwhile.
+    typedef std::shared_ptr<voxel_region::RegionFile> RegionRef;
+
+    struct OpenRegion {
+        RegionRef             file;
+        std::atomic<uint64_t> last_use{ 0 };   // region_clock at the last get_region()
+    };
+    typedef std::unordered_map<Vector3i, OpenRegion, RegionCoordHash> RegionMap;
+
+    /// Serializes saves of one region. Kept across close()/open() so a save
+    /// job still running from before cannot overwrite a newer one.
+    struct RegionSaveState {
+        std::mutex lock;
+        uint64_t   sequence = 0;   // latest save written (or being written)
+    };
+
+    std::string region_path(const Vector3i &region_coord) const;
+    void get_open_regions(std::vector<RegionRef> &out) const;
+
+    /// The region file for `region_coord`, opened on first use. Without
+    /// `create` a region with no file on disk comes back closed, which
+    /// RegionFile treats as empty. Null if no save is open.
+    RegionRef get_region(const Vector3i &region_coord, bool create) const;
+
+    std::shared_ptr<RegionSaveState> get_save_state(const Vector3i &region_coord);
+
+    /// Close least recently used regions until at most `max_open` remain,
+    /// skipping any a caller still holds or with uncommitted writes. Call
+    /// with `lock` held exclusively.
+    void evict_regions(size_t max_open) const;
+
+    mutable std::shared_mutex  lock;       // guards `regions`, `save_states`, `directory` and `generator`
+    mutable RegionMap          regions;
+    std::unordered_map<Vector3i, std::shared_ptr<RegionSaveState>, RegionCoordHash> save_states;
+    std::string                directory;
+    Ref<VoxelTerrainGenerator> generator;
+    std::atomic<int64_t>       read_ahead{ (int64_t)voxel_region::DEFAULT_READ_AHEAD };
+    std::atomic<float>         compaction_threshold{ 0.5f };
+    std::atomic<int>           codec_policy{ VoxelChunkCodec::POLICY_BALANCED };
+    std::atomic<uint64_t>      save_sequence{ 0 };
+    std::atomic<int>           max_open_regions{ DEFAULT_MAX_OPEN_REGIONS };
+    mutable std::atomic<uint64_t> region_clock{ 0 };
+};
@@ -0,0 +1,303 @@
+// voxel_surface_nets_mesher.cpp
+
+#include "voxel_surface_nets_mesher.h"
+#include "voxel_bits.h"
+#include "voxel_layout.h"
+
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+
+#include <math.h>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Internal per-thread buffers & helpers
+// -----------------------------------------------------------------------------
+
+static constexpr int N         = voxel_layout::SIZE;   // 64 voxels per axis
+static constexpr int CELLS     = N - 1;                // 63 cells per axis
+static constexpr int CELL_ROWS = CELLS * CELLS;
+
+// Cells 0..62 of a row (bit 63 would need voxel 64).
+static constexpr uint64_t CELL_BITS = ~0ull >> 1;
+// Edges owned by this chunk start at voxels 1..62 on every axis.
+static constexpr uint64_t OWNED_BITS = CELL_BITS & ~1ull;
+
+static thread_local uint8_t  g_sn_voxels_zxy[N * N * N];
+static thread_local uint64_t g_sn_opaque_mask[N * N];
+static thread_local uint64_t g_sn_row_cells[CELL_ROWS];   // mixed cells of row (x, y), bit z
+static thread_local uint32_t g_sn_row_base[CELL_ROWS];    // vertex index of the row's first mixed cell
+
+// Corner c of a cell is voxel (x + (c & 1), y + ((c >> 1) & 1), z + (c >> 2)).
+// For each of the 256 corner occupancy patterns: the mean of the crossing
+// edge midpoints and the unit normal pointing from solid to empty corners.
+struct CellTable {
+    float offset[256][3];
+    float normal[256][3];
+
+    CellTable() {
+        for (int mask = 0; mask < 256; ++mask) {
+            float sum[3] = { 0.0f, 0.0f, 0.0f };
+            float grad[3] = { 0.0f, 0.0f, 0.0f };
+            int crossings = 0;
+
+            for (int c = 0; c < 8; ++c) {
+                const float corner[3] = { float(c & 1), float((c >> 1) & 1), float(c >> 2) };
+                const float sign = (mask >> c) & 1 ? -1.0f : 1.0f;
+                for (int a = 0; a < 3; ++a) {
+                    grad[a] += sign * (corner[a] - 0.5f);
+                }
+
+                for (int a = 0; a < 3; ++a) {
+                    const int bit = 1 << a;
+                    if (c & bit) {
+                        continue;
+                    }
+                    if (((mask >> c) & 1) != ((mask >> (c | bit)) & 1)) {
+                        for (int k = 0; k < 3; ++k) {
+                            sum[k] += corner[k];
+                        }
+                        sum[a] += 0.5f;
+                        ++crossings;
+                    }
+                }
+            }
+
+            for (int a = 0; a < 3; ++a) {
+                offset[mask][a] = crossings > 0 ? sum[a] / crossings : 0.5f;
+            }
+
+            const float len = sqrtf(grad[0] * grad[0] + grad[1] * grad[1] + grad[2] * grad[2]);
+            if (len > 1e-6f) {
+                for (int a = 0; a < 3; ++a) {
+                    normal[mask][a] = grad[a] / len;
+                }
+            } else {
+                normal[mask][0] = 0.0f;
+                normal[mask][1] = 1.0f;
+                normal[mask][2] = 0.0f;
+            }
+        }
+    }
+};
+
+static const CellTable g_cell_table;
+
+static inline uint32_t cell_vertex(int cx, int cy, int cz) {
+    const int row = cy * CELLS + cx;
+    return g_sn_row_base[row] + (uint32_t)voxel_bits::popcount64(g_sn_row_cells[row] & ((1ull << cz) - 1));
+}
+
+// Two triangles, clockwise when seen from the side the normal points to.
+static inline void emit_quad(int32_t *indices, int &dst, uint32_t v0, uint32_t v1, uint32_t v2, uint32_t v3, bool flip) {
+    if (flip) {
+        const uint32_t t = v1;
+        v1 = v3;
+        v3 = t;
+    }
+    indices[dst++] = (int32_t)v0;
+    indices[dst++] = (int32_t)v1;
+    indices[dst++] = (int32_t)v2;
+    indices[dst++] = (int32_t)v0;
+    indices[dst++] = (int32_t)v2;
+    indices[dst++] = (int32_t)v3;
+}
+
+static inline uint8_t cell_material(int x, int y, int z) {
+    uint8_t materials[8];
+    int count = 0;
+    for (int c = 0; c < 8; ++c) {
+        const uint8_t m = g_sn_voxels_zxy[voxel_layout::index_zxy(x + (c & 1), y + ((c >> 1) & 1), z + (c >> 2))];
+        if (m != 0) {
+            materials[count++] = m;
+        }
+    }
+
+    uint8_t best = 0;
+    int best_votes = 0;
+    for (int i = 0; i < count; ++i) {
+        int votes = 0;
+        for (int j = 0; j < count; ++j) {
+            votes += materials[j] == materials[i];
+        }
+        if (votes > best_votes) {
+            best = materials[i];
+            best_votes = votes;
+        }
+    }
+    return best;
+}
+
+// Mesh whatever is currently in g_sn_voxels_zxy.
+static Dictionary mesh_scratch_zxy() {
+    const uint64_t *opaque = g_sn_opaque_mask;
+    voxel_layout::build_opaque_mask(g_sn_voxels_zxy, g_sn_opaque_mask);
+
+    // 1) Classify cells 63 at a time: a cell is mixed unless its 8 corners
+    //    (bits z and z+1 of four columns) are all solid or all empty.
+    uint32_t vertex_count = 0;
+    for (int y = 0; y < CELLS; ++y) {
+        for (int x = 0; x < CELLS; ++x) {
+            const uint64_t c00 = opaque[y * N + x];
+            const uint64_t c10 = opaque[y * N + x + 1];
+            const uint64_t c01 = opaque[(y + 1) * N + x];
+            const uint64_t c11 = opaque[(y + 1) * N + x + 1];
+
+            const uint64_t all   = c00 & c10 & c01 & c11;
+            const uint64_t any   = c00 | c10 | c01 | c11;
+            const uint64_t full  = all & (all >> 1);
+            const uint64_t empty = ~any & ~(any >> 1);
+            const uint64_t mixed = ~(full | empty) & CELL_BITS;
+
+            const int row = y * CELLS + x;
+            g_sn_row_cells[row] = mixed;
+            g_sn_row_base[row]  = vertex_count;
+            if (mixed) {
+                vertex_count += (uint32_t)voxel_bits::popcount64(mixed);
+            }
+        }
+    }
+
+    Dictionary out;
+    if (vertex_count == 0) {
+        return out;
+    }
+
+    // 2) One vertex per mixed cell.
+    PackedVector3Array vertices;
+    PackedVector3Array normals;
+    PackedByteArray    materials;
+    vertices.resize(vertex_count);
+    normals.resize(vertex_count);
+    materials.resize(vertex_count);
+
+    Vector3 *vertex_out   = vertices.ptrw();
+    Vector3 *normal_out   = normals.ptrw();
+    uint8_t *material_out = materials.ptrw();
+    uint32_t v = 0;
+
+    for (int y = 0; y < CELLS; ++y) {
+        for (int x = 0; x < CELLS; ++x) {
+            uint64_t mixed = g_sn_row_cells[y * CELLS + x];
+            if (mixed == 0) {
+                continue;
+            }
+
+            const uint64_t c00 = opaque[y * N + x];
+            const uint64_t c10 = opaque[y * N + x + 1];
+            const uint64_t c01 = opaque[(y + 1) * N + x];
+            const uint64_t c11 = opaque[(y + 1) * N + x + 1];
+
+            while (mixed) {
+                const int z = voxel_bits::ctz64(mixed);
+                mixed &= mixed - 1;
+
+                const int lo = int((c00 >> z) & 1) | int((c10 >> z) & 1) << 1 | int((c01 >> z) & 1) << 2 | int((c11 >> z) & 1) << 3;
+                const int hi = int((c00 >> (z + 1)) & 1) | int((c10 >> (z + 1)) & 1) << 1 | int((c01 >> (z + 1)) & 1) << 2 | int((c11 >> (z + 1)) & 1) << 3;
+                const int mask = lo | (hi << 4);
+
+                const float *off = g_cell_table.offset[mask];
+                const float *nrm = g_cell_table.normal[mask];
+
+                // Padded voxel i is centred at i - 0.5 in mesh space.
+                vertex_out[v]   = Vector3(x - 0.5f + off[0], y - 0.5f + off[1], z - 0.5f + off[2]);
+                normal_out[v]   = Vector3(nrm[0], nrm[1], nrm[2]);
+                material_out[v] = cell_material(x, y, z);
+                ++v;
+            }
+        }
+    }
+
+    // 3) One quad per solid/empty voxel pair owned by this chunk.
+    uint32_t quad_count = 0;
+    for (int y = 1; y < N - 1; ++y) {
+        for (int x = 1; x < N - 1; ++x) {
+            const uint64_t c = opaque[y * N + x];
+            const uint64_t cz = (c ^ (c >> 1)) & OWNED_BITS;
+            const uint64_t cx = (c ^ opaque[y * N + x + 1]) & OWNED_BITS;
+            const uint64_t cy = (c ^ opaque[(y + 1) * N + x]) & OWNED_BITS;
+            if (cz | cx | cy) {
+                quad_count += voxel_bits::popcount64(cz) + voxel_bits::popcount64(cx) + voxel_bits::popcount64(cy);
+            }
+        }
+    }
+
+    PackedInt32Array indices;
+    indices.resize(quad_count * 6);
+    int32_t *index_out = indices.ptrw();
+    int dst = 0;
+
+    for (int y = 1; y < N - 1; ++y) {
+        for (int x = 1; x < N - 1; ++x) {
+            const uint64_t c = opaque[y * N + x];
+
+            // Along z: voxel (x, y, z) vs (x, y, z + 1).
+            uint64_t bits = (c ^ (c >> 1)) & OWNED_BITS;
+            while (bits) {
+                const int z = voxel_bits::ctz64(bits);
+                bits &= bits - 1;
+                emit_quad(index_out, dst,
+                        cell_vertex(x - 1, y - 1, z), cell_vertex(x, y - 1, z),
+                        cell_vertex(x, y, z), cell_vertex(x - 1, y, z),
+                        (c >> z) & 1);
+            }
+
+            // Along x: voxel (x, y, z) vs (x + 1, y, z).
+            bits = (c ^ opaque[y * N + x + 1]) & OWNED_BITS;
+            while (bits) {
+                const int z = voxel_bits::ctz64(bits);
+                bits &= bits - 1;
+                emit_quad(index_out, dst,
+                        cell_vertex(x, y - 1, z - 1), cell_vertex(x, y, z - 1),
+                        cell_vertex(x, y, z), cell_vertex(x, y - 1, z),
+                        (c >> z) & 1);
+            }
+
+            // Along y: voxel (x, y, z) vs (x, y + 1, z).
+            bits = (c ^ opaque[(y + 1) * N + x]) & OWNED_BITS;
+            while (bits) {
+                const int z = voxel_bits::ctz64(bits);
+                bits &= bits - 1;
+                emit_quad(index_out, dst,
+                        cell_vertex(x - 1, y, z - 1), cell_vertex(x, y, z - 1),
+                        cell_vertex(x, y, z), cell_vertex(x - 1, y, z),
+                        !((c >> z) & 1));
+            }
+        }
+    }
+
+    out["vertices"]  = vertices;
+    out["normals"]   = normals;
+    out["materials"] = materials;
+    out["indices"]   = indices;
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// Godot class implementation
+// -----------------------------------------------------------------------------
+
+void VoxelSurfaceNetsMesher::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("mesh_chunk_surface", "material64_xyz"), &VoxelSurfaceNetsMesher::mesh_chunk_surface);
+    ClassDB::bind_method(D_METHOD("mesh_chunk", "chunk"), &VoxelSurfaceNetsMesher::mesh_chunk);
+}
+
+Dictionary VoxelSurfaceNetsMesher::mesh_chunk_surface(const PackedByteArray &material64_xyz) {
+    if (material64_xyz.size() != N * N * N) {
+        return Dictionary();
+    }
+
+    voxel_layout::xyz_to_zxy(material64_xyz.ptr(), g_sn_voxels_zxy);
+    return mesh_scratch_zxy();
+}
+
+Dictionary VoxelSurfaceNetsMesher::mesh_chunk(const Ref<VoxelChunk> &chunk) {
+    if (chunk.is_null()) {
+        return Dictionary();
+    }
+
+    chunk->unpack_materials_zxy(g_sn_voxels_zxy);
+    return mesh_scratch_zxy();
+}
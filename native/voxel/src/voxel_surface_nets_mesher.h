@@ -0,0 +1,50 @@
+// voxel_surface_nets_mesher.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+#include "voxel_chunk.h"
+
+using namespace godot;
+
+/// Naive Surface Nets mesher: smooth terrain from the same padded 64^3
+/// material arrays the greedy mesher takes.
+///
+/// Every cell (the cube between 8 neighbouring voxel centres) whose corners
+/// are not all solid or all empty gets one vertex, placed at the mean of
+/// its crossing edges; every solid/empty voxel pair inside the chunk emits
+/// a quad joining the 4 cells around it. Cell classification runs on the
+/// 64-bit opaque columns, so a row of 63 homogeneous cells is rejected with
+/// a few ANDs, and a cell's vertex index is its row's base index plus a
+/// popcount, which is how quads share vertices without a 63^3 index grid.
+///
+/// Positions use the greedy mesher's space: padded voxel i spans [i-1, i]
+/// on each axis, so the logical 62^3 region maps to [0, 62]. Neighbouring
+/// chunks produce identical vertices along their shared border.
+/// Thread-safe via thread_local scratch buffers.
+class VoxelSurfaceNetsMesher : public RefCounted {
+    GDCLASS(VoxelSurfaceNetsMesher, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    VoxelSurfaceNetsMesher() = default;
+    ~VoxelSurfaceNetsMesher() = default;
+
+    /// Mesh a 64^3 XYZ chunk (same input as VoxelGreedyMesher::mesh_chunk_quads).
+    ///
+    /// Returns a Dictionary:
+    ///   - "vertices":  PackedVector3Array
+    ///   - "normals":   PackedVector3Array (unit, pointing out of the solid)
+    ///   - "materials": PackedByteArray, one per vertex: the most common
+    ///                  material among the cell's solid corners
+    ///   - "indices":   PackedInt32Array, triangles, clockwise front faces
+    /// Empty dictionary if the input has the wrong size.
+    Dictionary mesh_chunk_surface(const PackedByteArray &material64_xyz);
+
+    /// Same output, reading a VoxelChunk in place.
+    Dictionary mesh_chunk(const Ref<VoxelChunk> &chunk);
+};
@@ -0,0 +1,454 @@
+// voxel_terrain_generator.cpp
+
+#include "voxel_terrain_generator.h"
+#include "voxel_noise.h"
+#include "voxel_shapes.h"
+#include "voxel_world.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+#include <string.h>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+static constexpr int N = VoxelTerrainGenerator::SIZE;
+
+// Largest cave lattice: nodes per axis at step 4, z padded to the SIMD width.
+static constexpr int MAX_LATTICE_NODES   = N / 4 + 2;
+static constexpr int MAX_LATTICE_NODES_Z = (MAX_LATTICE_NODES + 3) & ~3;
+
+static constexpr uint32_t CAVE_SEED_SALT = 0x63617665u;
+
+// Per-thread buffers: one chunk of voxels, its cave masks and noise lattice.
+static thread_local uint8_t  g_generate_scratch_zxy[VoxelChunk::VOXEL_COUNT];
+static thread_local uint64_t g_cave_masks[VoxelTerrainGenerator::COLUMN_COUNT];
+static thread_local float    g_cave_lattice[MAX_LATTICE_NODES * MAX_LATTICE_NODES * MAX_LATTICE_NODES_Z];
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelTerrainGenerator::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_seed", "value"), &VoxelTerrainGenerator::set_seed);
+    ClassDB::bind_method(D_METHOD("get_seed"), &VoxelTerrainGenerator::get_seed);
+    ClassDB::bind_method(D_METHOD("set_frequency", "value"), &VoxelTerrainGenerator::set_frequency);
+    ClassDB::bind_method(D_METHOD("get_frequency"), &VoxelTerrainGenerator::get_frequency);
+    ClassDB::bind_method(D_METHOD("set_octaves", "value"), &VoxelTerrainGenerator::set_octaves);
+    ClassDB::bind_method(D_METHOD("get_octaves"), &VoxelTerrainGenerator::get_octaves);
+    ClassDB::bind_method(D_METHOD("set_sea_level", "value"), &VoxelTerrainGenerator::set_sea_level);
+    ClassDB::bind_method(D_METHOD("get_sea_level"), &VoxelTerrainGenerator::get_sea_level);
+    ClassDB::bind_method(D_METHOD("set_base_height", "value"), &VoxelTerrainGenerator::set_base_height);
+    ClassDB::bind_method(D_METHOD("get_base_height"), &VoxelTerrainGenerator::get_base_height);
+    ClassDB::bind_method(D_METHOD("set_height_amplitude", "value"), &VoxelTerrainGenerator::set_height_amplitude);
+    ClassDB::bind_method(D_METHOD("get_height_amplitude"), &VoxelTerrainGenerator::get_height_amplitude);
+
+    ClassDB::bind_method(D_METHOD("set_stone_material", "value"), &VoxelTerrainGenerator::set_stone_material);
+    ClassDB::bind_method(D_METHOD("get_stone_material"), &VoxelTerrainGenerator::get_stone_material);
+    ClassDB::bind_method(D_METHOD("set_dirt_material", "value"), &VoxelTerrainGenerator::set_dirt_material);
+    ClassDB::bind_method(D_METHOD("get_dirt_material"), &VoxelTerrainGenerator::get_dirt_material);
+    ClassDB::bind_method(D_METHOD("set_grass_material", "value"), &VoxelTerrainGenerator::set_grass_material);
+    ClassDB::bind_method(D_METHOD("get_grass_material"), &VoxelTerrainGenerator::get_grass_material);
+    ClassDB::bind_method(D_METHOD("set_sand_material", "value"), &VoxelTerrainGenerator::set_sand_material);
+    ClassDB::bind_method(D_METHOD("get_sand_material"), &VoxelTerrainGenerator::get_sand_material);
+
+    ClassDB::bind_method(D_METHOD("set_caves_enabled", "value"), &VoxelTerrainGenerator::set_caves_enabled);
+    ClassDB::bind_method(D_METHOD("get_caves_enabled"), &VoxelTerrainGenerator::get_caves_enabled);
+    ClassDB::bind_method(D_METHOD("set_cave_frequency", "value"), &VoxelTerrainGenerator::set_cave_frequency);
+    ClassDB::bind_method(D_METHOD("get_cave_frequency"), &VoxelTerrainGenerator::get_cave_frequency);
+    ClassDB::bind_method(D_METHOD("set_cave_octaves", "value"), &VoxelTerrainGenerator::set_cave_octaves);
+    ClassDB::bind_method(D_METHOD("get_cave_octaves"), &VoxelTerrainGenerator::get_cave_octaves);
+    ClassDB::bind_method(D_METHOD("set_cave_threshold", "value"), &VoxelTerrainGenerator::set_cave_threshold);
+    ClassDB::bind_method(D_METHOD("get_cave_threshold"), &VoxelTerrainGenerator::get_cave_threshold);
+    ClassDB::bind_method(D_METHOD("set_cave_lattice_step", "value"), &VoxelTerrainGenerator::set_cave_lattice_step);
+    ClassDB::bind_method(D_METHOD("get_cave_lattice_step"), &VoxelTerrainGenerator::get_cave_lattice_step);
+
+    ClassDB::bind_method(D_METHOD("generate_chunk", "chunk_coord"), &VoxelTerrainGenerator::generate_chunk);
+    ClassDB::bind_method(D_METHOD("fill_chunk", "chunk", "chunk_coord"), &VoxelTerrainGenerator::fill_chunk);
+    ClassDB::bind_method(D_METHOD("get_settings_hash"), &VoxelTerrainGenerator::get_settings_hash);
+    ClassDB::bind_method(D_METHOD("get_height", "world_x", "world_z"), &VoxelTerrainGenerator::get_height);
+    ClassDB::bind_method(D_METHOD("get_moisture", "world_x", "world_z"), &VoxelTerrainGenerator::get_moisture);
+    ClassDB::bind_method(D_METHOD("get_biome", "world_x", "world_z"), &VoxelTerrainGenerator::get_biome);
+
+    ClassDB::bind_method(D_METHOD("set_heightmap_cache_size", "value"), &VoxelTerrainGenerator::set_heightmap_cache_size);
+    ClassDB::bind_method(D_METHOD("get_heightmap_cache_size"), &VoxelTerrainGenerator::get_heightmap_cache_size);
+    ClassDB::bind_method(D_METHOD("clear_heightmap_cache"), &VoxelTerrainGenerator::clear_heightmap_cache);
+
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "seed"), "set_seed", "get_seed");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "frequency"), "set_frequency", "get_frequency");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "octaves", PROPERTY_HINT_RANGE, "1,8"), "set_octaves", "get_octaves");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "sea_level"), "set_sea_level", "get_sea_level");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "base_height"), "set_base_height", "get_base_height");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "height_amplitude"), "set_height_amplitude", "get_height_amplitude");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "stone_material", PROPERTY_HINT_RANGE, "0,255"), "set_stone_material", "get_stone_material");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "dirt_material", PROPERTY_HINT_RANGE, "0,255"), "set_dirt_material", "get_dirt_material");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "grass_material", PROPERTY_HINT_RANGE, "0,255"), "set_grass_material", "get_grass_material");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "sand_material", PROPERTY_HINT_RANGE, "0,255"), "set_sand_material", "get_sand_material");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "heightmap_cache_size", PROPERTY_HINT_RANGE, "0,4096"), "set_heightmap_cache_size", "get_heightmap_cache_size");
+
+    ADD_GROUP("Caves", "");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "caves_enabled"), "set_caves_enabled", "get_caves_enabled");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "cave_frequency"), "set_cave_frequency", "get_cave_frequency");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "cave_octaves", PROPERTY_HINT_RANGE, "1,6"), "set_cave_octaves", "get_cave_octaves");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "cave_threshold", PROPERTY_HINT_RANGE, "0,1,0.001"), "set_cave_threshold", "get_cave_threshold");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "cave_lattice_step", PROPERTY_HINT_ENUM, "4:4,8:8"), "set_cave_lattice_step", "get_cave_lattice_step");
+}
+
+// -----------------------------------------------------------------------------
+// 2D fields
+// -----------------------------------------------------------------------------
+
+// Moisture and biome vary over much larger distances than the surface.
+static constexpr float    FIELD_FREQUENCY_SCALE = 0.25f;
+static constexpr int      FIELD_OCTAVES         = 2;
+static constexpr uint32_t MOISTURE_SEED_SALT    = 0x6D6F6973u;
+static constexpr uint32_t BIOME_SEED_SALT       = 0x62696F6Du;
+
+void VoxelTerrainGenerator::evaluate_field(Field field, const float *xs, const float *zs, float *out) const {
+    if (field == FIELD_HEIGHT) {
+        voxel_noise::fbm2_x4(xs, zs, (uint32_t)seed, octaves, 2.0f, 0.5f, out);
+        return;
+    }
+
+    const float fxs[4] = { xs[0] * FIELD_FREQUENCY_SCALE, xs[1] * FIELD_FREQUENCY_SCALE, xs[2] * FIELD_FREQUENCY_SCALE, xs[3] * FIELD_FREQUENCY_SCALE };
+    const float fzs[4] = { zs[0] * FIELD_FREQUENCY_SCALE, zs[1] * FIELD_FREQUENCY_SCALE, zs[2] * FIELD_FREQUENCY_SCALE, zs[3] * FIELD_FREQUENCY_SCALE };
+    const uint32_t salt = field == FIELD_MOISTURE ? MOISTURE_SEED_SALT : BIOME_SEED_SALT;
+    voxel_noise::fbm2_x4(fxs, fzs, (uint32_t)seed ^ salt, FIELD_OCTAVES, 2.0f, 0.5f, out);
+}
+
+void VoxelTerrainGenerator::compute_heightmap(int chunk_x, int chunk_z, VoxelHeightmap &out) const {
+    const int ox = chunk_x * VoxelWorld::CHUNK_STRIDE - 1;
+    const int oz = chunk_z * VoxelWorld::CHUNK_STRIDE - 1;
+
+    int hmin = INT32_MAX;
+    int hmax = INT32_MIN;
+
+    for (int x = 0; x < N; ++x) {
+        const float fx = (ox + x) * frequency;
+        const float xs[4] = { fx, fx, fx, fx };
+        const int row = x * N;
+
+        for (int z = 0; z < N; z += 4) {
+            const float zs[4] = {
+                (oz + z)     * frequency,
+                (oz + z + 1) * frequency,
+                (oz + z + 2) * frequency,
+                (oz + z + 3) * frequency,
+            };
+            float n[4];
+            evaluate_field(FIELD_HEIGHT, xs, zs, n);
+
+            for (int k = 0; k < 4; ++k) {
+                const int h = height_from_noise(n[k]);
+                out.heights[row + z + k] = h;
+                if (h < hmin) hmin = h;
+                if (h > hmax) hmax = h;
+            }
+        }
+    }
+
+    out.min_height = hmin;
+    out.max_height = hmax;
+}
+
+VoxelHeightmapCache::MapPtr VoxelTerrainGenerator::get_heightmap(int chunk_x, int chunk_z) const {
+    VoxelHeightmapCache::Key key;
+    key.cx   = chunk_x;
+    key.cz   = chunk_z;
+    key.seed = (uint32_t)seed;
+
+    return heightmap_cache.get_or_build(key, [&](VoxelHeightmap &map) {
+        compute_heightmap(chunk_x, chunk_z, map);
+    });
+}
+
+// Single columns go through the same 4-wide path as compute_heightmap() so
+// both agree to the bit.
+float VoxelTerrainGenerator::sample_field(Field field, int world_x, int world_z) const {
+    const float xs[4] = { world_x * frequency, 0.0f, 0.0f, 0.0f };
+    const float zs[4] = { world_z * frequency, 0.0f, 0.0f, 0.0f };
+    float n[4];
+    evaluate_field(field, xs, zs, n);
+    return n[0];
+}
+
+int VoxelTerrainGenerator::get_height(int world_x, int world_z) const {
+    return height_from_noise(sample_field(FIELD_HEIGHT, world_x, world_z));
+}
+
+float VoxelTerrainGenerator::get_moisture(int world_x, int world_z) const {
+    return sample_field(FIELD_MOISTURE, world_x, world_z) * 0.5f + 0.5f;
+}
+
+float VoxelTerrainGenerator::get_biome(int world_x, int world_z) const {
+    return sample_field(FIELD_BIOME, world_x, world_z) * 0.5f + 0.5f;
+}
+
+// -----------------------------------------------------------------------------
+// Caves
+// -----------------------------------------------------------------------------
+
+bool VoxelTerrainGenerator::compute_cave_masks(const Vector3i &chunk_coord, const VoxelHeightmap &heightmap, uint64_t *carve_masks) const {
+    const Vector3i origin = VoxelWorld::chunk_origin(chunk_coord);
+
+    // Only layers at or below the highest surface can hold solid voxels.
+    int y_end = heightmap.max_height - origin.y + 1;
+    y_end = y_end > N ? N : y_end;
+    if (!caves_enabled || y_end <= 0) {
+        return false;
+    }
+
+    const int   step     = cave_lattice_step;
+    const int   shift    = step == 4 ? 2 : 3;
+    const float inv_step = 1.0f / step;
+
+    // Lattice node i of an axis sits at world (n0 + i) * step; voxel w lies
+    // in cell (w - n0*step) >> shift and needs that node and the next.
+    const int n0x = VoxelWorld::floor_div(origin.x, step);
+    const int n0y = VoxelWorld::floor_div(origin.y, step);
+    const int n0z = VoxelWorld::floor_div(origin.z, step);
+    const int nx  = VoxelWorld::floor_div(origin.x + N - 1, step) - n0x + 2;
+    const int ny  = VoxelWorld::floor_div(origin.y + y_end - 1, step) - n0y + 2;
+    const int nz  = VoxelWorld::floor_div(origin.z + N - 1, step) - n0z + 2;
+    const int nz4 = (nz + 3) & ~3;
+
+    // 1) Ridged noise at the lattice nodes, four z nodes per SIMD call.
+    const uint32_t cave_seed = (uint32_t)seed ^ CAVE_SEED_SALT;
+    const float    node_freq = step * cave_frequency;
+
+    for (int iy = 0; iy < ny; ++iy) {
+        const float fy = (n0y + iy) * node_freq;
+        const float ys[4] = { fy, fy, fy, fy };
+
+        for (int ix = 0; ix < nx; ++ix) {
+            const float fx = (n0x + ix) * node_freq;
+            const float xs[4] = { fx, fx, fx, fx };
+            float *line = g_cave_lattice + (iy * nx + ix) * nz4;
+
+            for (int iz = 0; iz < nz4; iz += 4) {
+                const float zs[4] = {
+                    (n0z + iz)     * node_freq,
+                    (n0z + iz + 1) * node_freq,
+                    (n0z + iz + 2) * node_freq,
+                    (n0z + iz + 3) * node_freq,
+                };
+                voxel_noise::ridged3_x4(xs, ys, zs, cave_seed, cave_octaves, 2.0f, 0.5f, line + iz);
+            }
+        }
+    }
+
+    // 2) Per-axis cell indices and interpolation weights.
+    int   cell_x[N], cell_y[N], cell_z[N];
+    float t_x[N], t_y[N], t_z[N];
+    for (int i = 0; i < N; ++i) {
+        const int rx = origin.x + i - n0x * step;
+        const int ry = origin.y + i - n0y * step;
+        const int rz = origin.z + i - n0z * step;
+        cell_x[i] = rx >> shift;
+        cell_y[i] = ry >> shift;
+        cell_z[i] = rz >> shift;
+        t_x[i] = (rx & (step - 1)) * inv_step;
+        t_y[i] = (ry & (step - 1)) * inv_step;
+        t_z[i] = (rz & (step - 1)) * inv_step;
+    }
+
+    // Highest surface along each x row, to skip rows that are all air.
+    int row_top[N];
+    for (int x = 0; x < N; ++x) {
+        const int32_t *column_heights = heightmap.heights + x * N;
+        int top = column_heights[0];
+        for (int z = 1; z < N; ++z) {
+            top = column_heights[z] > top ? column_heights[z] : top;
+        }
+        row_top[x] = top;
+    }
+
+    // 3) Bilinear in x/y down to one line of z nodes, then linear along z.
+    const float threshold = cave_threshold;
+    float z_line[MAX_LATTICE_NODES_Z];
+    bool  any = false;
+
+    for (int y = 0; y < y_end; ++y) {
+        const int   wy  = origin.y + y;
+        const float ty  = t_y[y];
+        const int   row = cell_y[y] * nx;
+
+        for (int x = 0; x < N; ++x) {
+            if (wy > row_top[x]) {
+                carve_masks[y * N + x] = 0;
+                continue;
+            }
+
+            const float  tx  = t_x[x];
+            const float *l00 = g_cave_lattice + (row + cell_x[x]) * nz4;
+            const float *l10 = l00 + nz4;
+            const float *l01 = l00 + nx * nz4;
+            const float *l11 = l01 + nz4;
+
+            for (int iz = 0; iz < nz; ++iz) {
+                const float a = l00[iz] + (l10[iz] - l00[iz]) * tx;
+                const float b = l01[iz] + (l11[iz] - l01[iz]) * tx;
+                z_line[iz] = a + (b - a) * ty;
+            }
+
+            uint64_t bits = 0;
+            for (int z = 0; z < N; ++z) {
+                const float a = z_line[cell_z[z]];
+                const float v = a + (z_line[cell_z[z] + 1] - a) * t_z[z];
+                bits |= uint64_t(v > threshold) << z;
+            }
+
+            carve_masks[y * N + x] = bits;
+            any |= bits != 0;
+        }
+    }
+
+    if (!any) {
+        return false;
+    }
+    memset(carve_masks + y_end * N, 0, (N - y_end) * N * sizeof(uint64_t));
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Voxels
+// -----------------------------------------------------------------------------
+
+bool VoxelTerrainGenerator::generate_zxy(const Vector3i &chunk_coord, uint8_t *voxels_zxy, uint64_t *opaque_mask) const {
+    const VoxelHeightmapCache::MapPtr heightmap = get_heightmap(chunk_coord.x, chunk_coord.z);
+    const int32_t *heights = heightmap->heights;
+    const int hmin = heightmap->min_height;
+    const int hmax = heightmap->max_height;
+
+    const int oy = chunk_coord.y * VoxelWorld::CHUNK_STRIDE - 1;
+
+    for (int y = 0; y < N; ++y) {
+        const int wy = oy + y;
+        uint8_t *layer = voxels_zxy + y * N * N;
+
+        // Layers above every surface or below every dirt band are uniform.
+        if (wy > hmax) {
+            memset(layer, 0, N * N);
+            continue;
+        }
+        if (wy < hmin - 3) {
+            memset(layer, stone_material, N * N);
+            continue;
+        }
+
+        for (int x = 0; x < N; ++x) {
+            const int32_t *column_heights = heights + x * N;
+            uint8_t *row = layer + x * N;
+            for (int z = 0; z < N; ++z) {
+                row[z] = material_at(column_heights[z], wy);
+            }
+        }
+    }
+
+    const bool has_caves = compute_cave_masks(chunk_coord, *heightmap, g_cave_masks);
+    if (has_caves) {
+        const int lo[3] = { 0, 0, 0 };
+        const int hi[3] = { N, N, N };
+        int changed_min[3];
+        int changed_max[3];
+        voxel_shapes::apply_masks(g_cave_masks, lo, hi, 0, voxels_zxy, changed_min, changed_max);
+    }
+
+    if (opaque_mask == nullptr) {
+        return true;
+    }
+    if (stone_material == 0 || dirt_material == 0 || grass_material == 0 || sand_material == 0) {
+        return false;
+    }
+
+    // Column (x, z) is solid for local y <= top. Bucket each z bit by the
+    // first layer it drops out of, then sweep y once per x: 64 bit-ops per
+    // (x, y) word become one AND.
+    for (int x = 0; x < N; ++x) {
+        const int32_t *column_heights = heights + x * N;
+        uint64_t leaves_at[N + 1] = {};
+
+        for (int z = 0; z < N; ++z) {
+            int first_air = column_heights[z] - oy + 1;
+            first_air = first_air < 0 ? 0 : (first_air > N ? N : first_air);
+            leaves_at[first_air] |= 1ull << z;
+        }
+
+        uint64_t bits = ~0ull;
+        for (int y = 0; y < N; ++y) {
+            bits &= ~leaves_at[y];
+            opaque_mask[y * N + x] = has_caves ? bits & ~g_cave_masks[y * N + x] : bits;
+        }
+    }
+
+    return true;
+}
+
+Ref<VoxelChunk> VoxelTerrainGenerator::generate_chunk(const Vector3i &chunk_coord) const {
+    Ref<VoxelChunk> chunk;
+    chunk.instantiate();
+    fill_chunk(chunk, chunk_coord);
+    return chunk;
+}
+
+void VoxelTerrainGenerator::fill_chunk(const Ref<VoxelChunk> &chunk, const Vector3i &chunk_coord) const {
+    ERR_FAIL_COND_MSG(chunk.is_null(), "fill_chunk() needs a chunk.");
+
+    generate_zxy(chunk_coord, g_generate_scratch_zxy);
+    chunk->pack_materials_zxy(g_generate_scratch_zxy);
+}
+
+int64_t VoxelTerrainGenerator::get_settings_hash() const {
+    // FNV-1a over the version, then the settings in declaration order
+    // (floats by bit pattern).
+    uint32_t h = 2166136261u;
+    const auto mix = [&h](uint32_t v) {
+        for (int i = 0; i < 4; ++i) {
+            h = (h ^ ((v >> (i * 8)) & 0xFF)) * 16777619u;
+        }
+    };
+    const auto mix_float = [&mix](float v) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        mix(bits);
+    };
+
+    mix(GENERATOR_VERSION);
+    mix((uint32_t)seed);
+    mix_float(frequency);
+    mix((uint32_t)octaves);
+    mix((uint32_t)sea_level);
+    mix((uint32_t)base_height);
+    mix((uint32_t)height_amplitude);
+    mix(dirt_material | (grass_material << 8) | (stone_material << 16) | ((uint32_t)sand_material << 24));
+    mix(caves_enabled ? 1u : 0u);
+    if (caves_enabled) {
+        mix_float(cave_frequency);
+        mix((uint32_t)cave_octaves);
+        mix_float(cave_threshold);
+        mix((uint32_t)cave_lattice_step);
+    }
+
+    // Then a few noise evaluations at fixed points. A build whose float
+    // results differ (FMA contraction, another code path) hashes
+    // differently, so it refuses this build's diffs instead of replaying
+    // them onto slightly different terrain.
+    static constexpr float PROBE_XS[4] = { 0.37f, -13.1f, 251.9f, -4093.6f };
+    static constexpr float PROBE_YS[4] = { -2.9f, 0.55f, 17.25f, -311.4f };
+    static constexpr float PROBE_ZS[4] = { 7.3f, 0.61f, -87.25f, 1021.4f };
+    float probe[4];
+    evaluate_field(FIELD_HEIGHT, PROBE_XS, PROBE_ZS, probe);
+    for (float v : probe) {
+        mix_float(v);
+    }
+    if (caves_enabled) {
+        voxel_noise::ridged3_x4(PROBE_XS, PROBE_YS, PROBE_ZS, (uint32_t)seed ^ CAVE_SEED_SALT, cave_octaves, 2.0f, 0.5f, probe);
+        for (float v : probe) {
+            mix_float(v);
+        }
+    }
+    return (int64_t)h;
+}
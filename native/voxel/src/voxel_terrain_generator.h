@@ -0,0 +1,216 @@
+// voxel_terrain_generator.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+#include "voxel_chunk.h"
+#include "voxel_heightmap_cache.h"
+
+using namespace godot;
+
+/// Native port of TerrainGenerator.FillChunk: layered height-field terrain
+/// written straight into padded 64^3 chunks.
+///
+/// Column height is base_height + (fbm(x, z) * 0.5 + 0.5) * height_amplitude
+/// in world voxels; the surface voxel is grass (sand at or below
+/// sea_level + 1), the three below it dirt, everything deeper stone.
+/// Heights for all 64x64 columns of a chunk come from one SIMD fBm pass,
+/// then each (x, y) row of the ZXY output is filled from the 64 column
+/// heights it crosses; layers entirely above or below the surface are a
+/// single memset.
+///
+/// The column heights of a chunk column are kept in an LRU
+/// VoxelHeightmapCache keyed by (cx, cz, seed), so every chunk in a
+/// vertical stack shares one noise evaluation. Changing a setting that
+/// shapes them clears the cache. Moisture and biome are not needed to
+/// build chunks and are only evaluated when queried.
+///
+/// With caves enabled, solid voxels are carved wherever 3D ridged noise
+/// exceeds cave_threshold, which also cuts overhangs where tunnels break
+/// the surface. The noise is only evaluated on a coarse lattice (every 4th
+/// or 8th world voxel, 64-512x fewer samples than voxels) and trilinearly
+/// interpolated into per-column air masks that are applied 8 voxels at a
+/// time. Lattice nodes are aligned to world coordinates so neighbouring
+/// chunks agree on their shared padding.
+///
+/// Output is a pure function of the settings and the chunk coordinate, so
+/// any thread may generate any chunk. Configure the generator before
+/// handing it to workers; the settings themselves are not locked.
+///
+/// Chunk coordinates follow VoxelWorld: chunk c covers world voxels
+/// [c*62 - 1, c*62 + 63) including its padding.
+class VoxelTerrainGenerator : public RefCounted {
+    GDCLASS(VoxelTerrainGenerator, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    static constexpr int SIZE         = VoxelChunk::SIZE;
+    static constexpr int COLUMN_COUNT = SIZE * SIZE;
+
+    /// Part of get_settings_hash(). Bump it with any change to the
+    /// generation code that alters output for the same settings, so diffs
+    /// saved against the old output fail to load instead of decoding onto
+    /// different terrain.
+    static constexpr uint32_t GENERATOR_VERSION = 1;
+
+    VoxelTerrainGenerator() = default;
+    ~VoxelTerrainGenerator() = default;
+
+    // --- Settings (defaults match TerrainGenerator.cs and the default palette) ---
+
+    void set_seed(int value) { seed = value; }
+    int get_seed() const { return seed; }
+
+    void set_frequency(float value) { frequency = value; heightmap_cache.clear(); }
+    float get_frequency() const { return frequency; }
+
+    void set_octaves(int value) { octaves = value < 1 ? 1 : value; heightmap_cache.clear(); }
+    int get_octaves() const { return octaves; }
+
+    void set_sea_level(int value) { sea_level = value; }
+    int get_sea_level() const { return sea_level; }
+
+    void set_base_height(int value) { base_height = value; heightmap_cache.clear(); }
+    int get_base_height() const { return base_height; }
+
+    void set_height_amplitude(int value) { height_amplitude = value; heightmap_cache.clear(); }
+    int get_height_amplitude() const { return height_amplitude; }
+
+    void set_stone_material(int value) { stone_material = (uint8_t)value; }
+    int get_stone_material() const { return stone_material; }
+
+    void set_dirt_material(int value) { dirt_material = (uint8_t)value; }
+    int get_dirt_material() const { return dirt_material; }
+
+    void set_grass_material(int value) { grass_material = (uint8_t)value; }
+    int get_grass_material() const { return grass_material; }
+
+    void set_sand_material(int value) { sand_material = (uint8_t)value; }
+    int get_sand_material() const { return sand_material; }
+
+    // --- Caves ---
+
+    void set_caves_enabled(bool value) { caves_enabled = value; }
+    bool get_caves_enabled() const { return caves_enabled; }
+
+    void set_cave_frequency(float value) { cave_frequency = value; }
+    float get_cave_frequency() const { return cave_frequency; }
+
+    void set_cave_octaves(int value) { cave_octaves = value < 1 ? 1 : value; }
+    int get_cave_octaves() const { return cave_octaves; }
+
+    /// Ridged noise (0..1) above which a voxel is carved; higher means thinner tunnels.
+    void set_cave_threshold(float value) { cave_threshold = value; }
+    float get_cave_threshold() const { return cave_threshold; }
+
+    /// Spacing of the noise lattice, 4 or 8 voxels.
+    void set_cave_lattice_step(int value) { cave_lattice_step = value <= 4 ? 4 : 8; }
+    int get_cave_lattice_step() const { return cave_lattice_step; }
+
+    // --- Generation ---
+
+    /// New chunk filled with the terrain of `chunk_coord`.
+    Ref<VoxelChunk> generate_chunk(const Vector3i &chunk_coord) const;
+
+    /// Overwrite the materials of an existing chunk (flags are kept).
+    void fill_chunk(const Ref<VoxelChunk> &chunk, const Vector3i &chunk_coord) const;
+
+    /// Hash (32-bit) of GENERATOR_VERSION, every setting that shapes the
+    /// output and a few probe evaluations of the noise: generators with the
+    /// same hash produce the same chunks, also across builds and platforms. Saves
+    /// that store chunks as diffs against the generator (VoxelStorage)
+    /// record it. Settings are plain fields: do not change them while
+    /// another thread generates or saves with this generator.
+    int64_t get_settings_hash() const;
+
+    /// Surface height (world y of the top solid voxel) of world column (x, z).
+    int get_height(int world_x, int world_z) const;
+
+    /// Moisture (0..1) and biome selector (0..1) of world column (x, z).
+    float get_moisture(int world_x, int world_z) const;
+    float get_biome(int world_x, int world_z) const;
+
+    /// Maximum number of chunk columns kept in the heightmap cache (0 disables it).
+    void set_heightmap_cache_size(int value) { heightmap_cache.set_capacity(value < 0 ? 0 : (uint32_t)value); }
+    int get_heightmap_cache_size() const { return (int)heightmap_cache.get_capacity(); }
+
+    void clear_heightmap_cache() { heightmap_cache.clear(); }
+
+    // --- Native access (not bound) ---
+
+    /// Heights of chunk column (chunk_x, chunk_z), from the cache or
+    /// freshly computed (and cached).
+    VoxelHeightmapCache::MapPtr get_heightmap(int chunk_x, int chunk_z) const;
+
+    /// Evaluate the heights of a chunk column without touching the cache.
+    void compute_heightmap(int chunk_x, int chunk_z, VoxelHeightmap &out) const;
+
+    /// Air carve masks of the chunk (one word per (x, y), indexed y*64 + x,
+    /// bit z = carved). Returns false if nothing is carved: caves are
+    /// disabled, the chunk lies entirely above the surface, or no voxel
+    /// passes the threshold. The masks are then unspecified (rows may have
+    /// been written) and must not be applied.
+    bool compute_cave_masks(const Vector3i &chunk_coord, const VoxelHeightmap &heightmap, uint64_t *carve_masks) const;
+
+    /// Write the chunk into a 64^3 ZXY buffer (idx = z + x*64 + y*64*64).
+    ///
+    /// If `opaque_mask` is given it also receives the mesher's opaque mask
+    /// (one word per (x, y), indexed y*64 + x, bit z = solid), derived from
+    /// the column heights rather than by scanning the voxels. Returns false
+    /// (mask left untouched) when a layer material is 0 and the heights
+    /// alone cannot tell which voxels are solid.
+    bool generate_zxy(const Vector3i &chunk_coord, uint8_t *voxels_zxy, uint64_t *opaque_mask = nullptr) const;
+
+    /// Material of world voxel row `world_y` in a column whose surface is at `height`.
+    inline uint8_t material_at(int height, int world_y) const {
+        if (world_y > height) {
+            return 0;
+        }
+        if (world_y == height) {
+            return world_y <= sea_level + 1 ? sand_material : grass_material;
+        }
+        return world_y >= height - 3 ? dirt_material : stone_material;
+    }
+
+private:
+    int   seed             = 628;
+    float frequency        = 0.001f;
+    int   octaves          = 4;
+    int   sea_level        = 0;
+    int   base_height      = 1;
+    int   height_amplitude = 24;
+
+    uint8_t dirt_material  = 1;
+    uint8_t grass_material = 2;
+    uint8_t stone_material = 3;
+    uint8_t sand_material  = 4;
+
+    bool  caves_enabled     = false;
+    float cave_frequency    = 0.02f;
+    int   cave_octaves      = 2;
+    float cave_threshold    = 0.94f;
+    int   cave_lattice_step = 4;
+
+    mutable VoxelHeightmapCache heightmap_cache;
+
+    inline int height_from_noise(float n) const {
+        return base_height + (int)((n * 0.5f + 0.5f) * height_amplitude);
+    }
+
+    enum Field {
+        FIELD_HEIGHT,
+        FIELD_MOISTURE,
+        FIELD_BIOME,
+    };
+
+    /// Raw fBm (-1..1) of one 2D field at four world columns, given as
+    /// world coordinates times `frequency` (one SIMD pass). Each field is
+    /// its own pass, so callers only pay for the fields they use.
+    void evaluate_field(Field field, const float *xs, const float *zs, float *out) const;
+
+    /// evaluate_field() at a single world column.
+    float sample_field(Field field, int world_x, int world_z) const;
+};
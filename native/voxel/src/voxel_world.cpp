@@ -0,0 +1,315 @@
+// voxel_world.cpp
+
+#include "voxel_world.h"
+#include "voxel_edit.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+#include <mutex>
+
+using namespace godot;
+
+// -----------------------------------------------------------------------------
+// Godot bindings
+// -----------------------------------------------------------------------------
+
+void VoxelWorld::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_chunk", "coord", "chunk"), &VoxelWorld::set_chunk);
+    ClassDB::bind_method(D_METHOD("get_chunk", "coord"), &VoxelWorld::get_chunk);
+    ClassDB::bind_method(D_METHOD("has_chunk", "coord"), &VoxelWorld::has_chunk);
+    ClassDB::bind_method(D_METHOD("remove_chunk", "coord"), &VoxelWorld::remove_chunk);
+    ClassDB::bind_method(D_METHOD("clear"), &VoxelWorld::clear);
+
+    ClassDB::bind_method(D_METHOD("get_chunk_count"), &VoxelWorld::get_chunk_count);
+    ClassDB::bind_method(D_METHOD("get_chunk_coords"), &VoxelWorld::get_chunk_coords);
+
+    ClassDB::bind_method(D_METHOD("set_generator", "value"), &VoxelWorld::set_generator);
+    ClassDB::bind_method(D_METHOD("get_generator"), &VoxelWorld::get_generator);
+    ClassDB::bind_method(D_METHOD("materialize_chunk", "coord"), &VoxelWorld::materialize_chunk);
+
+    ClassDB::bind_method(D_METHOD("get_neighbors", "coord"), &VoxelWorld::get_neighbors);
+    ClassDB::bind_method(D_METHOD("get_chunk_coords_in_region", "from", "to"), &VoxelWorld::get_chunk_coords_in_region);
+
+    ClassDB::bind_method(D_METHOD("world_to_chunk", "voxel"), &VoxelWorld::world_to_chunk);
+    ClassDB::bind_method(D_METHOD("get_voxel", "voxel"), &VoxelWorld::get_voxel);
+    ClassDB::bind_method(D_METHOD("begin_edit"), &VoxelWorld::begin_edit);
+
+    ClassDB::bind_method(D_METHOD("pop_remesh_queue", "max_count"), &VoxelWorld::pop_remesh_queue, DEFVAL(-1));
+    ClassDB::bind_method(D_METHOD("get_remesh_queue_size"), &VoxelWorld::get_remesh_queue_size);
+    ClassDB::bind_method(D_METHOD("take_dirty_region", "coord"), &VoxelWorld::take_dirty_region);
+    ClassDB::bind_method(D_METHOD("mark_chunk_dirty", "coord"), &VoxelWorld::mark_chunk_dirty);
+
+    ClassDB::bind_method(D_METHOD("take_unsaved_chunks"), &VoxelWorld::take_unsaved_chunks);
+    ClassDB::bind_method(D_METHOD("get_unsaved_chunk_count"), &VoxelWorld::get_unsaved_chunk_count);
+    ClassDB::bind_method(D_METHOD("mark_chunk_unsaved", "coord"), &VoxelWorld::mark_chunk_unsaved);
+}
+
+// -----------------------------------------------------------------------------
+// Chunk map
+// -----------------------------------------------------------------------------
+
+void VoxelWorld::set_chunk(const Vector3i &coord, const Ref<VoxelChunk> &chunk) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    if (chunk.is_null()) {
+        chunks.erase(coord);
+        return;
+    }
+    chunks.insert(coord, chunk);
+}
+
+Ref<VoxelChunk> VoxelWorld::get_chunk(const Vector3i &coord) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    const Ref<VoxelChunk> *chunk = chunks.getptr(coord);
+    return chunk != nullptr ? *chunk : Ref<VoxelChunk>();
+}
+
+bool VoxelWorld::has_chunk(const Vector3i &coord) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return chunks.has(coord);
+}
+
+bool VoxelWorld::remove_chunk(const Vector3i &coord) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    return chunks.erase(coord);
+}
+
+void VoxelWorld::clear() {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    chunks.clear();
+}
+
+int VoxelWorld::get_chunk_count() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return (int)chunks.size();
+}
+
+TypedArray<Vector3i> VoxelWorld::get_chunk_coords() const {
+    TypedArray<Vector3i> out;
+
+    std::shared_lock<std::shared_mutex> guard(lock);
+    for (const KeyValue<Vector3i, Ref<VoxelChunk>> &E : chunks) {
+        out.push_back(E.key);
+    }
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// Generation
+// -----------------------------------------------------------------------------
+
+void VoxelWorld::set_generator(const Ref<VoxelTerrainGenerator> &value) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    generator = value;
+}
+
+Ref<VoxelTerrainGenerator> VoxelWorld::get_generator() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return generator;
+}
+
+Ref<VoxelChunk> VoxelWorld::materialize_chunk(const Vector3i &coord) {
+    Ref<VoxelTerrainGenerator> gen;
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        const Ref<VoxelChunk> *chunk = chunks.getptr(coord);
+        if (chunk != nullptr) {
+            return *chunk;
+        }
+        gen = generator;
+    }
+    if (gen.is_null()) {
+        return Ref<VoxelChunk>();
+    }
+
+    // Generate outside the lock; if another thread got there first, keep its chunk.
+    const Ref<VoxelChunk> generated = gen->generate_chunk(coord);
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    const Ref<VoxelChunk> *existing = chunks.getptr(coord);
+    if (existing != nullptr) {
+        return *existing;
+    }
+    chunks.insert(coord, generated);
+    return generated;
+}
+
+// -----------------------------------------------------------------------------
+// Bulk queries
+// -----------------------------------------------------------------------------
+
+void VoxelWorld::get_neighborhood(const Vector3i &coord, Ref<VoxelChunk> out[NEIGHBORHOOD_SIZE]) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                const Ref<VoxelChunk> *chunk = chunks.getptr(coord + Vector3i(dx, dy, dz));
+                out[neighbor_index(dx, dy, dz)] = chunk != nullptr ? *chunk : Ref<VoxelChunk>();
+            }
+        }
+    }
+}
+
+Array VoxelWorld::get_neighbors(const Vector3i &coord) const {
+    Ref<VoxelChunk> neighborhood[NEIGHBORHOOD_SIZE];
+    get_neighborhood(coord, neighborhood);
+
+    Array out;
+    out.resize(NEIGHBORHOOD_SIZE);
+    for (int i = 0; i < NEIGHBORHOOD_SIZE; ++i) {
+        out[i] = neighborhood[i];
+    }
+    return out;
+}
+
+TypedArray<Vector3i> VoxelWorld::get_chunk_coords_in_region(const Vector3i &from, const Vector3i &to) const {
+    TypedArray<Vector3i> out;
+    for_each_chunk_in_region(from, to, [&out](const Vector3i &coord, const Ref<VoxelChunk> &) {
+        out.push_back(coord);
+    });
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// Voxels & edits
+// -----------------------------------------------------------------------------
+
+int VoxelWorld::get_voxel(const Vector3i &voxel) const {
+    const Vector3i coord = chunk_of_voxel(voxel);
+    const Ref<VoxelChunk> chunk = get_chunk(coord);
+    if (chunk.is_null()) {
+        return 0;
+    }
+    const Vector3i local = voxel - chunk_origin(coord);
+    return chunk->get_voxel(local.x, local.y, local.z);
+}
+
+Ref<VoxelEdit> VoxelWorld::begin_edit() {
+    Ref<VoxelEdit> edit;
+    edit.instantiate();
+    edit->set_world(Ref<VoxelWorld>(this));
+    return edit;
+}
+
+// -----------------------------------------------------------------------------
+// Dirty tracking
+// -----------------------------------------------------------------------------
+
+void VoxelWorld::mark_dirty(const Vector3i &coord, const Vector3i &min, const Vector3i &max) {
+    std::lock_guard<std::mutex> guard(dirty_lock);
+
+    DirtyRegion *region = dirty_regions.getptr(coord);
+    if (region == nullptr) {
+        dirty_regions.insert(coord, DirtyRegion());
+        region = dirty_regions.getptr(coord);
+    }
+
+    if (region->has_bounds) {
+        region->min = region->min.min(min);
+        region->max = region->max.max(max);
+    } else {
+        region->min        = min;
+        region->max        = max;
+        region->has_bounds = true;
+    }
+
+    if (!region->queued) {
+        region->queued = true;
+        remesh_queue.push_back(coord);
+    }
+
+    if (!unsaved.has(coord)) {
+        unsaved.insert(coord);
+        unsaved_queue.push_back(coord);
+    }
+}
+
+void VoxelWorld::mark_chunk_dirty(const Vector3i &coord) {
+    mark_dirty(coord, Vector3i(0, 0, 0), Vector3i(VoxelChunk::SIZE - 1, VoxelChunk::SIZE - 1, VoxelChunk::SIZE - 1));
+}
+
+TypedArray<Vector3i> VoxelWorld::pop_remesh_queue(int max_count) {
+    TypedArray<Vector3i> out;
+
+    std::lock_guard<std::mutex> guard(dirty_lock);
+
+    const uint32_t count = (max_count < 0 || (uint32_t)max_count > remesh_queue.size())
+        ? remesh_queue.size()
+        : (uint32_t)max_count;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const Vector3i &coord = remesh_queue[i];
+        DirtyRegion *region = dirty_regions.getptr(coord);
+        if (region != nullptr) {
+            if (region->has_bounds) {
+                region->queued = false;
+            } else {
+                dirty_regions.erase(coord);
+            }
+        }
+        out.push_back(coord);
+    }
+
+    // Shift the remainder down (the queue is usually drained whole).
+    const uint32_t remaining = remesh_queue.size() - count;
+    for (uint32_t i = 0; i < remaining; ++i) {
+        remesh_queue[i] = remesh_queue[count + i];
+    }
+    remesh_queue.resize(remaining);
+
+    return out;
+}
+
+int VoxelWorld::get_remesh_queue_size() const {
+    std::lock_guard<std::mutex> guard(dirty_lock);
+    return (int)remesh_queue.size();
+}
+
+AABB VoxelWorld::take_dirty_region(const Vector3i &coord) {
+    std::lock_guard<std::mutex> guard(dirty_lock);
+
+    DirtyRegion *region = dirty_regions.getptr(coord);
+    if (region == nullptr || !region->has_bounds) {
+        return AABB();
+    }
+
+    const Vector3i size = region->max - region->min + Vector3i(1, 1, 1);
+    const AABB out(Vector3(region->min.x, region->min.y, region->min.z), Vector3(size.x, size.y, size.z));
+
+    if (region->queued) {
+        // Keep the entry so edits before the next pop merge into the queued remesh.
+        region->has_bounds = false;
+    } else {
+        dirty_regions.erase(coord);
+    }
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// Save tracking
+// -----------------------------------------------------------------------------
+
+TypedArray<Vector3i> VoxelWorld::take_unsaved_chunks() {
+    TypedArray<Vector3i> out;
+
+    std::lock_guard<std::mutex> guard(dirty_lock);
+    for (uint32_t i = 0; i < unsaved_queue.size(); ++i) {
+        out.push_back(unsaved_queue[i]);
+    }
+    unsaved.clear();
+    unsaved_queue.clear();
+    return out;
+}
+
+int VoxelWorld::get_unsaved_chunk_count() const {
+    std::lock_guard<std::mutex> guard(dirty_lock);
+    return (int)unsaved_queue.size();
+}
+
+void VoxelWorld::mark_chunk_unsaved(const Vector3i &coord) {
+    std::lock_guard<std::mutex> guard(dirty_lock);
+    if (!unsaved.has(coord)) {
+        unsaved.insert(coord);
+        unsaved_queue.push_back(coord);
+    }
+}
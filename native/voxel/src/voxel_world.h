@@ -0,0 +1,218 @@
+// voxel_world.h
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "voxel_chunk.h"
+#include "voxel_terrain_generator.h"
+
+using namespace godot;
+
+/// Cheap hash for integer chunk coordinates: pack 21 bits per axis into one
+/// 64-bit key and take the high half of a Fibonacci multiply. Chunk
+/// coordinates stay far inside +/-2^20, so the packing is collision free.
+struct VoxelChunkCoordHasher {
+    static _FORCE_INLINE_ uint32_t hash(const Vector3i &p_coord) {
+        const uint64_t key = (uint64_t(uint32_t(p_coord.x)) & 0x1FFFFF)
+                           | ((uint64_t(uint32_t(p_coord.y)) & 0x1FFFFF) << 21)
+                           | ((uint64_t(uint32_t(p_coord.z)) & 0x1FFFFF) << 42);
+        return uint32_t((key * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+};
+
+class VoxelEdit;
+
+/// Sparse map of integer chunk coordinates to VoxelChunk storage.
+///
+/// Replaces the script-side Dictionary<Vector3I, VoxelMesh>: lookups are a
+/// single hash probe, all 26 neighbours come back from one call under one
+/// lock, and any number of threads may read concurrently (shared lock) while
+/// inserts and removals take the lock exclusively.
+///
+/// World voxel coordinates map onto chunks with a stride of CHUNK_STRIDE
+/// (62): chunk c owns world voxels [c*62, c*62 + 62) at local 1..62, and its
+/// local 0 and 63 layers duplicate the neighbours' border voxels, which is
+/// the padded layout the mesher consumes.
+class VoxelWorld : public RefCounted {
+    GDCLASS(VoxelWorld, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    /// Index of a neighbour in get_neighbors(): (dx+1) + (dy+1)*3 + (dz+1)*9.
+    /// The centre chunk itself is at index 13.
+    static constexpr int NEIGHBORHOOD_SIZE = 27;
+
+    static inline int neighbor_index(int dx, int dy, int dz) {
+        return (dx + 1) + (dy + 1) * 3 + (dz + 1) * 9;
+    }
+
+    /// World voxels owned by one chunk along each axis (padded size minus 2).
+    static constexpr int CHUNK_STRIDE = VoxelChunk::SIZE - 2;
+
+    static inline int floor_div(int a, int b) {
+        const int q = a / b;
+        return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+    }
+
+    /// Chunk that owns world voxel `voxel`.
+    static inline Vector3i chunk_of_voxel(const Vector3i &voxel) {
+        return Vector3i(floor_div(voxel.x, CHUNK_STRIDE), floor_div(voxel.y, CHUNK_STRIDE), floor_div(voxel.z, CHUNK_STRIDE));
+    }
+
+    /// World position of local voxel (0, 0, 0) of chunk `coord` (a padding voxel).
+    static inline Vector3i chunk_origin(const Vector3i &coord) {
+        return Vector3i(coord.x * CHUNK_STRIDE - 1, coord.y * CHUNK_STRIDE - 1, coord.z * CHUNK_STRIDE - 1);
+    }
+
+    VoxelWorld() = default;
+    ~VoxelWorld() = default;
+
+    // --- Chunk map ---
+
+    void set_chunk(const Vector3i &coord, const Ref<VoxelChunk> &chunk);
+    Ref<VoxelChunk> get_chunk(const Vector3i &coord) const;
+    bool has_chunk(const Vector3i &coord) const;
+    bool remove_chunk(const Vector3i &coord);
+    void clear();
+
+    int get_chunk_count() const;
+    TypedArray<Vector3i> get_chunk_coords() const;
+
+    // --- Generation ---
+
+    /// Terrain used by materialize_chunk() for chunks that are not loaded.
+    void set_generator(const Ref<VoxelTerrainGenerator> &value);
+    Ref<VoxelTerrainGenerator> get_generator() const;
+
+    /// The loaded chunk at `coord`, or, if there is none and a generator is
+    /// set, a freshly generated one that is inserted into the world. Lets
+    /// untouched terrain stay unstored (VoxelGreedyMesher::mesh_generated)
+    /// until an edit needs its voxels. Returns null without a generator.
+    Ref<VoxelChunk> materialize_chunk(const Vector3i &coord);
+
+    // --- Bulk queries ---
+
+    /// The 3x3x3 block of chunks around `coord` (27 entries, see neighbor_index()).
+    /// Missing chunks are null.
+    Array get_neighbors(const Vector3i &coord) const;
+
+    /// Coordinates of all loaded chunks with from <= coord < to (per axis).
+    TypedArray<Vector3i> get_chunk_coords_in_region(const Vector3i &from, const Vector3i &to) const;
+
+    // --- Voxels & edits ---
+
+    Vector3i world_to_chunk(const Vector3i &voxel) const { return chunk_of_voxel(voxel); }
+
+    /// Material at a world voxel, read from its owning chunk (0 if not loaded).
+    int get_voxel(const Vector3i &voxel) const;
+
+    /// Start a batched edit. Nothing is written until VoxelEdit::commit().
+    Ref<VoxelEdit> begin_edit();
+
+    // --- Dirty tracking ---
+
+    /// Chunks waiting for a remesh, each queued once no matter how many edits
+    /// touched it. Pass max_count < 0 to take the whole queue.
+    TypedArray<Vector3i> pop_remesh_queue(int max_count = -1);
+    int get_remesh_queue_size() const;
+
+    /// Local voxel bounds (0..63, padding included) changed since the last
+    /// call for this chunk; an empty AABB if nothing changed.
+    AABB take_dirty_region(const Vector3i &coord);
+
+    /// Queue a remesh of the whole chunk (e.g. after replacing its data).
+    void mark_chunk_dirty(const Vector3i &coord);
+
+    // --- Save tracking ---
+
+    /// Chunks changed by edits (mark_dirty, mark_chunk_dirty, VoxelEdit)
+    /// since they were last taken, each listed once; the set is cleared.
+    /// Chunks inserted with set_chunk() or materialize_chunk() are not
+    /// marked, so loading never schedules a save. VoxelStorage::save_world()
+    /// uses this to write only what changed.
+    TypedArray<Vector3i> take_unsaved_chunks();
+    int get_unsaved_chunk_count() const;
+
+    /// Schedule a chunk for the next save without a remesh, e.g. after a
+    /// failed save or after writing to the VoxelChunk directly.
+    void mark_chunk_unsaved(const Vector3i &coord);
+
+    // --- Native access (not bound) ---
+
+    /// Fill `out` with the 27 chunks around `coord` under a single shared lock.
+    void get_neighborhood(const Vector3i &coord, Ref<VoxelChunk> out[NEIGHBORHOOD_SIZE]) const;
+
+    /// Call `fn(coord, chunk)` for every loaded chunk with from <= coord < to.
+    /// Runs under the shared lock: `fn` must not modify the world.
+    template <typename F>
+    void for_each_chunk_in_region(const Vector3i &from, const Vector3i &to, F &&fn) const;
+
+    /// Grow the dirty region of `coord` by the inclusive local box [min, max]
+    /// and queue the chunk for remeshing if it is not queued yet.
+    void mark_dirty(const Vector3i &coord, const Vector3i &min, const Vector3i &max);
+
+private:
+    struct DirtyRegion {
+        Vector3i min;
+        Vector3i max;                // inclusive
+        bool     has_bounds = false; // false once taken while still queued
+        bool     queued     = false;
+    };
+
+    typedef HashMap<Vector3i, Ref<VoxelChunk>, VoxelChunkCoordHasher> ChunkMap;
+
+    mutable std::shared_mutex  lock;
+    ChunkMap                   chunks;
+    Ref<VoxelTerrainGenerator> generator;
+
+    mutable std::mutex                                       dirty_lock;
+    HashMap<Vector3i, DirtyRegion, VoxelChunkCoordHasher>    dirty_regions;
+    LocalVector<Vector3i>                                    remesh_queue;
+    HashSet<Vector3i, VoxelChunkCoordHasher>                 unsaved;
+    LocalVector<Vector3i>                                    unsaved_queue;
+};
+
+template <typename F>
+void VoxelWorld::for_each_chunk_in_region(const Vector3i &from, const Vector3i &to, F &&fn) const {
+    if (from.x >= to.x || from.y >= to.y || from.z >= to.z) {
+        return;
+    }
+
+    std::shared_lock<std::shared_mutex> guard(lock);
+
+    const int64_t volume = int64_t(to.x - from.x) * (to.y - from.y) * (to.z - from.z);
+
+    if (volume <= (int64_t)chunks.size()) {
+        // Small region: probe each coordinate.
+        for (int y = from.y; y < to.y; ++y) {
+            for (int z = from.z; z < to.z; ++z) {
+                for (int x = from.x; x < to.x; ++x) {
+                    const Vector3i coord(x, y, z);
+                    const Ref<VoxelChunk> *chunk = chunks.getptr(coord);
+                    if (chunk != nullptr) {
+                        fn(coord, *chunk);
+                    }
+                }
+            }
+        }
+    } else {
+        // Region larger than the world: scan the map once.
+        for (const KeyValue<Vector3i, Ref<VoxelChunk>> &E : chunks) {
+            const Vector3i &c = E.key;
+            if (c.x >= from.x && c.x < to.x && c.y >= from.y && c.y < to.y && c.z >= from.z && c.z < to.z) {
+                fn(c, E.value);
+            }
+        }
+    }
+}
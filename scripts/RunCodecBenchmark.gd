@@ -0,0 +1,150 @@
+extends Node
+
+# Compares the chunk save codecs (VoxelChunkCodec) on a corpus of chunks:
+# compression ratio and encode / decode throughput per codec, then what
+# each storage policy picks. Every codec must also decode the corpus back
+# to the same materials. The corpus is every chunk of `save_directory`
+# when set, otherwise a block of generated terrain with caves.
+
+@export var iterations: int = 5
+@export var run_on_ready: bool = true
+@export var save_directory: String = ""
+@export var terrain_seed: int = 1337
+@export var chunks_x: int = 4
+@export var chunks_y: int = 6
+@export var chunks_z: int = 4
+
+const CHUNK_BYTES := 64 * 64 * 64
+
+func _ready() -> void:
+	if run_on_ready:
+		run_benchmark()
+
+
+func _load_corpus() -> Array:
+	var corpus := []
+
+	if save_directory != "":
+		var storage := VoxelStorage.new()
+		if not storage.open(save_directory):
+			push_error("Could not open save '%s'." % save_directory)
+			return corpus
+		for chunk in storage.load_chunks(storage.get_chunk_coords()):
+			if chunk != null:
+				corpus.append(chunk)
+		return corpus
+
+	var generator := VoxelTerrainGenerator.new()
+	generator.seed = terrain_seed
+	generator.caves_enabled = true
+
+	# Centred on y = 0 so the block spans sky, surface and deep caves.
+	for y in range(-chunks_y / 2, chunks_y - chunks_y / 2):
+		for z in chunks_z:
+			for x in chunks_x:
+				corpus.append(generator.generate_chunk(Vector3i(x, y, z)))
+	return corpus
+
+
+func _mb_per_s(bytes: int, usec: int) -> float:
+	return float(bytes) / max(float(usec), 1.0)
+
+
+func _bench_codec(corpus: Array, codec: int) -> Dictionary:
+	var payloads := []
+	var encoded_bytes := 0
+	var encode_usec := 0
+	var decode_usec := 0
+
+	for i in iterations:
+		payloads.clear()
+		encoded_bytes = 0
+
+		var start := Time.get_ticks_usec()
+		for chunk in corpus:
+			var data: PackedByteArray = VoxelChunkCodec.encode(chunk, codec)
+			encoded_bytes += data.size()
+			payloads.append(data)
+		encode_usec += Time.get_ticks_usec() - start
+
+		start = Time.get_ticks_usec()
+		for data in payloads:
+			VoxelChunkCodec.decode(data)
+		decode_usec += Time.get_ticks_usec() - start
+
+	# Round trip, outside the timed loops: compared as raw payloads.
+	var mismatches := 0
+	for i in payloads.size():
+		var decoded: VoxelChunk = VoxelChunkCodec.decode(payloads[i])
+		if decoded == null or VoxelChunkCodec.encode(decoded, VoxelChunkCodec.CODEC_RAW) \
+				!= VoxelChunkCodec.encode(corpus[i], VoxelChunkCodec.CODEC_RAW):
+			mismatches += 1
+
+	var raw_bytes := corpus.size() * CHUNK_BYTES
+	return {
+		"mismatches": mismatches,
+		"ratio": float(raw_bytes) / float(max(encoded_bytes, 1)),
+		"encoded": encoded_bytes,
+		"encode_mb_s": _mb_per_s(raw_bytes * iterations, encode_usec),
+		"decode_mb_s": _mb_per_s(raw_bytes * iterations, decode_usec),
+	}
+
+
+func _bench_policy(corpus: Array, policy: int) -> Dictionary:
+	var encoded_bytes := 0
+	var picks := {}
+
+	var start := Time.get_ticks_usec()
+	for chunk in corpus:
+		var data: PackedByteArray = VoxelChunkCodec.encode_with_policy(chunk, policy)
+		encoded_bytes += data.size()
+		var name := VoxelChunkCodec.get_codec_name(VoxelChunkCodec.get_codec(data))
+		picks[name] = picks.get(name, 0) + 1
+	var usec := Time.get_ticks_usec() - start
+
+	var raw_bytes := corpus.size() * CHUNK_BYTES
+	return {
+		"ratio": float(raw_bytes) / float(max(encoded_bytes, 1)),
+		"encode_mb_s": _mb_per_s(raw_bytes, usec),
+		"picks": picks,
+	}
+
+
+func run_benchmark() -> void:
+	print("=== Chunk Codec Benchmark ===")
+
+	if not ClassDB.class_exists("VoxelChunkCodec"):
+		push_error("VoxelChunkCodec GDExtension class not found. Check register_class and .gdextension setup.")
+		return
+
+	var corpus := _load_corpus()
+	if corpus.is_empty():
+		push_error("Empty corpus.")
+		return
+
+	print("Chunks: ", corpus.size(), " (", corpus.size() * CHUNK_BYTES / (1024 * 1024), " MiB raw)")
+	print("Iterations: ", iterations)
+
+	print("--- Codecs ---")
+	for codec in VoxelChunkCodec.CODEC_COUNT:
+		# Diffs need a generator to diff against; VoxelStorage writes those.
+		if codec == VoxelChunkCodec.CODEC_GENERATOR_DIFF:
+			continue
+		var r := _bench_codec(corpus, codec)
+		print("%-14s ratio %7.1f  %10d bytes  encode %8.1f MB/s  decode %8.1f MB/s" % [
+			VoxelChunkCodec.get_codec_name(codec), r["ratio"], r["encoded"], r["encode_mb_s"], r["decode_mb_s"]])
+		if r["mismatches"] > 0:
+			push_error("%s: %d chunks did not survive the round trip." % [
+				VoxelChunkCodec.get_codec_name(codec), r["mismatches"]])
+		assert(r["mismatches"] == 0, "Codec round trip mismatch.")
+
+	print("--- Policies ---")
+	var policies := {
+		"fastest": VoxelChunkCodec.POLICY_FASTEST,
+		"balanced": VoxelChunkCodec.POLICY_BALANCED,
+		"smallest": VoxelChunkCodec.POLICY_SMALLEST,
+	}
+	for policy_name in policies:
+		var r := _bench_policy(corpus, policies[policy_name])
+		print("%-14s ratio %7.1f  encode %8.1f MB/s  picks %s" % [
+			policy_name, r["ratio"], r["encode_mb_s"], r["picks"]])
@@ -2,6 +2,7 @@ extends Node3D
 
 @export var iterations: int = 100
 @export var run_on_ready: bool = true
+@export var show_surface_nets: bool = true
 
 const SIZE := 64
 
@@ -15,85 +16,96 @@ func _set_voxel(vox: PackedByteArray, x: int, y: int, z: int, v: int) -> void:
 	vox[idx] = v
 
 
+func _time_ms(callable: Callable) -> Dictionary:
+	var total_ms := 0.0
+	var min_ms := INF
+	var max_ms := 0.0
+	var result: Variant = null
+
+	for i in iterations:
+		var start := Time.get_ticks_usec()
+		result = callable.call()
+		var end := Time.get_ticks_usec()
+
+		var ms := float(end - start) / 1000.0
+		total_ms += ms
+		if ms < min_ms:
+			min_ms = ms
+		if ms > max_ms:
+			max_ms = ms
+
+	return {
+		"avg": total_ms / float(iterations),
+		"min": min_ms,
+		"max": max_ms,
+		"result": result,
+	}
+
+
+func _print_timing(name: String, timing: Dictionary) -> void:
+	print("--- ", name, " ---")
+	print("avg mesh time: ", "%.4f ms" % timing["avg"])
+	print("min mesh time: ", "%.4f ms" % timing["min"])
+	print("max mesh time: ", "%.4f ms" % timing["max"])
+
+
 func run_benchmark() -> void:
 	print("=== GDScript Native Mesher Benchmark ===")
 
-	# 1) Check if the Voxel class is actually registered
-	var exists := ClassDB.class_exists("Voxel")
-	print("Class 'Voxel' exists? ", exists)
-	if not exists:
-		push_error("Voxel GDExtension class not found. Check register_class and .gdextension setup.")
-		return
+	# 1) Check the GDExtension classes are registered
+	for cls in ["VoxelGreedyMesher", "VoxelSurfaceNetsMesher"]:
+		var exists := ClassDB.class_exists(cls)
+		print("Class '%s' exists? " % cls, exists)
+		if not exists:
+			push_error("%s GDExtension class not found. Check register_class and .gdextension setup." % cls)
+			return
 
 	# 2) Build a simple test chunk: 64^3 padded, inner 62^3 logical.
 	var vox := PackedByteArray()
 	vox.resize(SIZE * SIZE * SIZE)
 
-	# Simple terrain: solid column up to some height
+	# Rolling terrain so the smooth mesher has slopes to follow
 	for z in SIZE:
 		for x in SIZE:
-			var height := 20
+			var height := 20 + int(6.0 * sin(x * 0.15) * cos(z * 0.11))
 			for y in SIZE:
 				if y <= height:
 					_set_voxel(vox, x, y, z, 1)
 				else:
 					_set_voxel(vox, x, y, z, 0)
 
-	# 3) Warmup + benchmark
-	var last_vertices: PackedVector3Array = PackedVector3Array()
-	var last_indices: PackedInt32Array = PackedInt32Array()
-	var last_uvs: PackedVector2Array = PackedVector2Array()
-
-	print("Calling Voxel.mesh_chunk once (warmup)...")
-
-	var t0 := Time.get_ticks_msec()
-	var result := Voxel.mesh_chunk(vox)    # if bound as STATIC
-	var t1 := Time.get_ticks_msec()
-	print("Warmup took: %s ms" % (t1 - t0))
-
-	last_vertices = result["vertices"]
-	last_indices  = result["indices"]
-	last_uvs      = result["uvs"]
-
-	var total_ms := 0.0
-	var min_ms := INF
-	var max_ms := 0.0
+	var greedy := VoxelGreedyMesher.new()
+	var surface_nets := VoxelSurfaceNetsMesher.new()
 
-	for i in iterations:
-		var start := Time.get_ticks_msec()
-		result = Voxel.mesh_chunk(vox)
-		var end := Time.get_ticks_msec()
-
-		var ms := float(end - start)
-		total_ms += ms
-		if ms < min_ms:
-			min_ms = ms
-		if ms > max_ms:
-			max_ms = ms
+	# 3) Warmup + benchmark, same input for both engines
+	greedy.mesh_chunk_quads(vox)
+	surface_nets.mesh_chunk_surface(vox)
 
-	var avg_ms := total_ms / float(iterations)
+	var greedy_timing := _time_ms(func(): return greedy.mesh_chunk_quads(vox))
+	var nets_timing := _time_ms(func(): return surface_nets.mesh_chunk_surface(vox))
 
-	last_vertices = result["vertices"]
-	last_indices  = result["indices"]
-	last_uvs      = result["uvs"]
+	var quads: PackedInt64Array = greedy_timing["result"]
+	var surface: Dictionary = nets_timing["result"]
+	var vertices: PackedVector3Array = surface.get("vertices", PackedVector3Array())
+	var normals: PackedVector3Array = surface.get("normals", PackedVector3Array())
+	var indices: PackedInt32Array = surface.get("indices", PackedInt32Array())
 
 	print("=== Native mesher results ===")
 	print("Iterations: ", iterations)
-	print("avg mesh time: ", "%.4f ms" % avg_ms)
-	print("min mesh time: ", "%.4f ms" % min_ms)
-	print("max mesh time: ", "%.4f ms" % max_ms)
-	print("last vertex count: ", last_vertices.size())
-	print("last index count:  ", last_indices.size())
-	print("last uv count:     ", last_uvs.size())
-
-	# 4) Build and display a mesh from the last result
-	if last_vertices.size() > 0:
+	_print_timing("Greedy (VoxelGreedyMesher.mesh_chunk_quads)", greedy_timing)
+	print("quad count: ", quads.size())
+	_print_timing("Surface Nets (VoxelSurfaceNetsMesher.mesh_chunk_surface)", nets_timing)
+	print("vertex count: ", vertices.size())
+	print("index count:  ", indices.size())
+
+	# 4) Build and display the smooth mesh from the last result
+	if show_surface_nets and vertices.size() > 0:
 		var arrays := []
 		arrays.resize(Mesh.ARRAY_MAX)
 
-		arrays[Mesh.ARRAY_VERTEX] = last_vertices
-		arrays[Mesh.ARRAY_INDEX]  = last_indices
-		arrays[Mesh.ARRAY_TEX_UV] = last_uvs
+		arrays[Mesh.ARRAY_VERTEX] = vertices
+		arrays[Mesh.ARRAY_NORMAL] = normals
+		arrays[Mesh.ARRAY_INDEX]  = indices
 
 		var mesh := ArrayMesh.new()
 		mesh.add_surface_from_arrays(Mesh.PRIMITIVE_TRIANGLES, arrays)